@@ -0,0 +1,174 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Times the solver itself on small problems, where the cost of an evaluation
+// is about that of the bookkeeping around it.
+//
+//     benchmark [size ...] [fixtures ...]
+//
+// Each size, 2 and 6 by default, is solved 2000 times on the Rosenbrock
+// function from slightly different starts. The best time per evaluation of 11
+// repetitions is printed for the solver as it was before the policies
+// (benchmark_baseline.h), for NelderMead, which has the default policies, and
+// for a solver with no constraint policy at all, the least a search can cost.
+// The last column is NelderMead over the baseline. All three make the same
+// evaluations, which is checked.
+//
+// Arguments that are not numbers name fixture files written by worstcase.cpp.
+// Their cases of each size are replayed on the standard worst-case families,
+// and the best time per evaluation of 11 repetitions is printed. Every case
+// must make as many evaluations as when it was found, which is also checked.
+
+#include "nm.h"
+#include "nm_worstcase.h"
+#include "benchmark_baseline.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+
+struct UnconstrainedPolicies : NelderMeadDefaultPolicies {
+    using Constraint = NelderMeadNoConstraint;
+};
+
+static double rosenbrock(const std::vector<double> & x)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i + 1 < x.size(); i++) {
+        double a = x[i + 1] - x[i] * x[i];
+        double b = 1.0 - x[i];
+        sum += 100.0 * a * a + b * b;
+    }
+    return sum;
+}
+
+// Nanoseconds per evaluation of one repetition
+template <typename Solver>
+static double timeSolver(Solver & solver, uint32_t size, uint64_t & evaluations)
+{
+    const int solves = 2000;
+
+    evaluations = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < solves; i++) {
+        std::vector<double> start(size, -1.2);
+        start[0] += i * 1.0e-4;
+        solver.exec(start, 1.0e-10, 1.0);
+        evaluations += solver.getLastExecResults().evalCount;
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / evaluations;
+}
+
+// Replays the cases of one size from a fixture file and prints the best time
+// per evaluation. False if a case did not make the evaluations it was found
+// with.
+static bool replayFixtures(const char * path, uint32_t size)
+{
+    NelderMeadWorstCaseSearch search(1);
+    for (const NelderMeadObjectiveFamily & family : NelderMeadWorstCaseSearch::getStandardFamilies(size)) {
+        search.addFamily(family);
+    }
+    std::ifstream in(path);
+    std::vector<NelderMeadWorstCase> cases = search.readFixtures(in);
+    if (cases.empty()) {
+        return true;
+    }
+
+    const int repetitions = 11;
+    uint64_t evaluations = 0;
+    double ns = HUGE_VAL;
+    bool same = true;
+    for (int rep = 0; rep < repetitions; rep++) {
+        evaluations = 0;
+        double seconds = 0.0;
+        for (NelderMeadWorstCase worstCase : cases) {
+            uint32_t found = worstCase.evalCount;
+            search.replay(worstCase);
+            same = same && worstCase.evalCount == found;
+            evaluations += worstCase.evalCount;
+            seconds += worstCase.seconds;
+        }
+        ns = std::min(ns, seconds * 1.0e9 / evaluations);
+    }
+
+    printf("%-24s %6u %6u %12llu %10.1f\n", path, size, (uint32_t)cases.size(), (unsigned long long)evaluations, ns);
+    return same;
+}
+
+int main(int argc, char ** argv)
+{
+    std::vector<uint32_t> sizes;
+    std::vector<const char*> fixtures;
+    for (int i = 1; i < argc; i++) {
+        if (isdigit((unsigned char)argv[i][0])) {
+            sizes.push_back((uint32_t)strtoul(argv[i], nullptr, 10));
+        }
+        else {
+            fixtures.push_back(argv[i]);
+        }
+    }
+    if (sizes.empty()) {
+        sizes = { 2, 6 };
+    }
+
+    printf("%6s %12s %10s %12s %14s %7s\n", "size", "evaluations", "baseline", "NelderMead", "unconstrained", "ratio");
+
+    bool same = true;
+    for (uint32_t size : sizes) {
+        BaselineNelderMead baseline(size, rosenbrock, nullptr);
+        NelderMead solver(size, rosenbrock, nullptr);
+        BasicNelderMead<UnconstrainedPolicies> unconstrained(size, rosenbrock);
+
+        // The repetitions of the solvers take turns, so that a change in the
+        // speed of the machine affects all of them alike
+        const int repetitions = 11;
+        uint64_t baselineEvaluations = 0;
+        uint64_t evaluations = 0;
+        uint64_t unconstrainedEvaluations = 0;
+        double baselineNs = HUGE_VAL;
+        double ns = HUGE_VAL;
+        double unconstrainedNs = HUGE_VAL;
+        for (int rep = 0; rep < repetitions; rep++) {
+            baselineNs = std::min(baselineNs, timeSolver(baseline, size, baselineEvaluations));
+            ns = std::min(ns, timeSolver(solver, size, evaluations));
+            unconstrainedNs = std::min(unconstrainedNs, timeSolver(unconstrained, size, unconstrainedEvaluations));
+        }
+
+        printf("%6u %12llu %10.1f %12.1f %14.1f %7.3f\n", size, (unsigned long long)evaluations,
+            baselineNs, ns, unconstrainedNs, ns / baselineNs);
+        same = same && evaluations == baselineEvaluations && evaluations == unconstrainedEvaluations;
+    }
+
+    if (!same) {
+        printf("the solvers made different evaluations\n");
+        return 1;
+    }
+
+    if (!fixtures.empty()) {
+        printf("\n%-24s %6s %6s %12s %10s\n", "fixtures", "size", "cases", "evaluations", "ns/eval");
+    }
+    for (const char * path : fixtures) {
+        if (!std::ifstream(path)) {
+            printf("could not read %s\n", path);
+            return 1;
+        }
+        for (uint32_t size : sizes) {
+            same = replayFixtures(path, size) && same;
+        }
+    }
+
+    if (!same) {
+        printf("a fixture made different evaluations than when it was found\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Times the three batch orders on problems whose data does not fit in the
+// last level cache.
+//
+//     benchmark_batch [threads] [megabytes] [problems]
+//
+// The data, 1024 MB by default, is split into 1024 regions. Every problem
+// reads one region, one double per cache line, on every evaluation, and fits
+// a small model to it. The problems, 2048 by default, pick their regions at
+// random, so in the Arrival order most evaluations read a region that was
+// last used long ago, while the Grouped and Interleaved orders run the
+// problems of a region back to back on one worker. The thread count defaults
+// to the number of cores. The orders take turns over 3 repetitions and the
+// fastest time of each is printed. Every order must give the same results;
+// the program returns 1 if they do not.
+
+#include "nm_batch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+
+
+static const char * orderNames[] = { "Arrival", "Grouped", "Interleaved" };
+
+int main(int argc, char ** argv)
+{
+    uint32_t threads = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    size_t megabytes = argc > 2 ? (size_t)strtoul(argv[2], nullptr, 10) : 1024;
+    uint32_t problemCount = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 10) : 2048;
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    const uint32_t regions = 1024;
+    const size_t lineDoubles = 64 / sizeof(double);
+    size_t regionDoubles = megabytes * 1024 * 1024 / sizeof(double) / regions;
+    regionDoubles -= regionDoubles % lineDoubles;
+    if (regionDoubles == 0) {
+        regionDoubles = lineDoubles;
+    }
+
+    std::vector<double> data(regionDoubles * regions);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (double & d : data) {
+        d = uniform(rng);
+    }
+
+    // Each problem fits a + b * k to the samples k of its region, at a rate
+    // that differs from problem to problem
+    std::vector<NelderMeadBatchProblem> problems(problemCount);
+    for (uint32_t i = 0; i < problemCount; i++) {
+        uint32_t region = rng() % regions;
+        const double * samples = &data[region * regionDoubles];
+        size_t count = regionDoubles / lineDoubles;
+        double rate = 1.0 + 0.001 * i;
+
+        problems[i].localityKey = region;
+        problems[i].size = 2;
+        problems[i].evalFunc = [samples, count, rate](const std::vector<double> & x) {
+            double sum = 0.0;
+            for (size_t k = 0; k < count; k++) {
+                double r = x[0] + x[1] * rate * k / count - samples[k * lineDoubles];
+                sum += r * r;
+            }
+            return sum / count;
+        };
+        problems[i].start = { 0.0, 0.0 };
+        problems[i].tolerance = 1.0e-8;
+    }
+
+    printf("%u threads, %zu MB in %u regions, %u problems\n", threads, data.size() * sizeof(double) >> 20, regions, problemCount);
+    printf("%-12s %10s %12s %10s\n", "order", "seconds", "evaluations", "speedup");
+
+    std::vector<std::unique_ptr<NelderMeadBatch>> batches;
+    for (int order = 0; order < 3; order++) {
+        batches.emplace_back(new NelderMeadBatch(threads));
+        batches[order]->setOrder((NelderMeadBatchOrder)order);
+        for (const NelderMeadBatchProblem & problem : problems) {
+            batches[order]->add(problem);
+        }
+    }
+
+    const int repetitions = 3;
+    double best[3] = { 0.0, 0.0, 0.0 };
+    for (int rep = 0; rep < repetitions; rep++) {
+        for (int order = 0; order < 3; order++) {
+            auto begin = std::chrono::steady_clock::now();
+            batches[order]->exec();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            if (rep == 0 || seconds < best[order]) {
+                best[order] = seconds;
+            }
+        }
+    }
+
+    const std::vector<NelderMeadResults> & first = batches[0]->getLastExecResults();
+    bool same = true;
+    for (int order = 0; order < 3; order++) {
+        const std::vector<NelderMeadResults> & results = batches[order]->getLastExecResults();
+        uint64_t evaluations = 0;
+        for (size_t i = 0; i < results.size(); i++) {
+            evaluations += results[i].evalCount;
+            same = same && results[i].evalCount == first[i].evalCount &&
+                memcmp(&results[i].min, &first[i].min, sizeof(double)) == 0;
+        }
+        printf("%-12s %10.3f %12llu %9.2fx\n", orderNames[order], best[order], (unsigned long long)evaluations, best[0] / best[order]);
+    }
+
+    if (!same) {
+        printf("the orders gave different results\n");
+        return 1;
+    }
+    return 0;
+}
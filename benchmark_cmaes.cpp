@@ -0,0 +1,141 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Compares CmaEs with NelderMead in 32 variables, and times CmaEs across
+// thread counts.
+//
+//     benchmark_cmaes [threads ...]
+//
+// The objectives are an ellipsoid with a condition number of 1e6 started from
+// ones, the Rosenbrock function started from zeros and the Rastrigin function
+// started from threes, which CmaEs solves with IPOP restarts. Every
+// evaluation also spins for 10 microseconds, so that evaluating a generation
+// in parallel can pay off. NelderMead, which evaluates one point at a time,
+// runs once. CmaEs runs on one thread and then on every given number of
+// threads, 4, 16 and 64 by default. The evaluations, minimum and seconds of
+// each are printed. CmaEs must make the same search on every thread count;
+// the program returns 1 if it does not.
+
+#include "cmaes.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+
+static const uint32_t size = 32;
+static const uint32_t evaluationMicroseconds = 10;
+
+static double ellipsoid(const std::vector<double> & x)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < x.size(); i++) {
+        sum += pow(1.0e6, (double)i / (x.size() - 1)) * x[i] * x[i];
+    }
+    return sum;
+}
+
+static double rosenbrock(const std::vector<double> & x)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i + 1 < x.size(); i++) {
+        double a = x[i + 1] - x[i] * x[i];
+        double b = 1.0 - x[i];
+        sum += 100.0 * a * a + b * b;
+    }
+    return sum;
+}
+
+static double rastrigin(const std::vector<double> & x)
+{
+    double sum = 10.0 * x.size();
+    for (double xi : x) {
+        sum += xi * xi - 10.0 * cos(2.0 * M_PI * xi);
+    }
+    return sum;
+}
+
+struct Problem {
+    const char * name;
+    double (*func)(const std::vector<double>&);
+    double start;
+    double scale;
+    CmaEsRestart restart;
+};
+
+static const Problem problems[] = {
+    { "ellipsoid", ellipsoid, 1.0, 1.0, CmaEsRestart::None },
+    { "rosenbrock", rosenbrock, 0.0, 0.5, CmaEsRestart::None },
+    { "rastrigin", rastrigin, 3.0, 3.0, CmaEsRestart::Ipop }
+};
+
+static double seconds(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int main(int argc, char ** argv)
+{
+    std::vector<uint32_t> threadCounts = { 1 };
+    for (int i = 1; i < argc; i++) {
+        threadCounts.push_back((uint32_t)strtoul(argv[i], nullptr, 10));
+    }
+    if (threadCounts.size() == 1) {
+        threadCounts.insert(threadCounts.end(), { 4, 16, 64 });
+    }
+
+    printf("%-12s %-12s %8s %12s %12s %10s\n", "objective", "solver", "threads", "evaluations", "minimum", "seconds");
+
+    bool same = true;
+    for (const Problem & problem : problems) {
+        auto evalFunc = [&problem](const std::vector<double> & x) {
+            auto begin = std::chrono::steady_clock::now();
+            double value = problem.func(x);
+            while (std::chrono::steady_clock::now() - begin < std::chrono::microseconds(evaluationMicroseconds)) {
+            }
+            return value;
+        };
+        std::vector<double> start(size, problem.start);
+
+        NelderMead solver(size, evalFunc, nullptr);
+        solver.setMaxIterations(400000);
+        auto begin = std::chrono::steady_clock::now();
+        solver.exec(start, 1.0e-12, problem.scale);
+        double nmSeconds = seconds(begin);
+        const NelderMeadResults & nm = solver.getLastExecResults();
+        printf("%-12s %-12s %8u %12u %12.3g %10.3f\n", problem.name, "Nelder-Mead", 1, nm.evalCount, nm.min, nmSeconds);
+
+        NelderMeadResults first;
+        for (size_t t = 0; t < threadCounts.size(); t++) {
+            CmaEs es(size, evalFunc, nullptr);
+            es.setThreadCount(threadCounts[t]);
+            es.setMaxEvaluations(400000);
+            es.setRestart(problem.restart);
+            es.setTargetValue(1.0e-8);
+
+            begin = std::chrono::steady_clock::now();
+            es.exec(start, 1.0e-12, problem.scale);
+            double esSeconds = seconds(begin);
+            const NelderMeadResults & results = es.getLastExecResults();
+            printf("%-12s %-12s %8u %12u %12.3g %10.3f\n", problem.name, "CMA-ES", threadCounts[t], results.evalCount, results.min, esSeconds);
+
+            if (t == 0) {
+                first = results;
+            }
+            else {
+                same = same && results.evalCount == first.evalCount && results.min == first.min && results.minValues == first.minValues;
+            }
+        }
+    }
+
+    if (!same) {
+        printf("CMA-ES made different searches on different thread counts\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Measures the throughput of an evaluation farm on this machine against
+// evaluating in process.
+//
+//     benchmark_farm [workers] [microseconds ...]
+//
+// Starts the given number of workers, 4 by default, on background threads
+// listening on free tcp ports of 127.0.0.1. Each evaluation busy-waits for a
+// fixed time, 0, 10, 100 and 1000 microseconds by default, so the cost of the
+// farm itself shows next to evaluations of known cost. For every cost and
+// every number of workers from 1 up, the program prints the evaluations per
+// second:
+//
+// - batch: 1000 points of 10 variables handed to the farm in one call, the
+//   way the initial simplex and a shrink are evaluated
+// - single: points sent one at a time and waited for, the way the trial
+//   points of an iteration are evaluated
+// - in process: the same points evaluated one after the other by the caller
+//
+// Workers on the same machine share its cores with each other and with the
+// coordinator, so the batch numbers only grow with the worker count while
+// there are idle cores.
+
+#include "nm_farm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <memory>
+
+
+// Sums the point and then spins until the cost of the evaluation has passed
+static double timedEvaluation(const std::vector<double> & x, uint32_t microseconds)
+{
+    auto begin = std::chrono::steady_clock::now();
+    double sum = 0.0;
+    for (double xi : x) {
+        sum += xi * xi;
+    }
+    while (std::chrono::steady_clock::now() - begin < std::chrono::microseconds(microseconds)) {
+    }
+    return sum;
+}
+
+static double seconds(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int main(int argc, char ** argv)
+{
+    uint32_t maxWorkers = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : 4;
+    std::vector<uint32_t> costs;
+    for (int i = 2; i < argc; i++) {
+        costs.push_back((uint32_t)strtoul(argv[i], nullptr, 10));
+    }
+    if (costs.empty()) {
+        costs = { 0, 10, 100, 1000 };
+    }
+    if (maxWorkers == 0) {
+        maxWorkers = 1;
+    }
+
+    const uint32_t size = 10;
+    const uint32_t batchCount = 1000;
+    std::vector<std::vector<double>> points(batchCount, std::vector<double>(size));
+    std::vector<const std::vector<double>*> pointers(batchCount);
+    for (uint32_t i = 0; i < batchCount; i++) {
+        for (uint32_t j = 0; j < size; j++) {
+            points[i][j] = 0.001 * i + j;
+        }
+        pointers[i] = &points[i];
+    }
+    std::vector<double> values(batchCount);
+
+    printf("%8s %8s %14s %14s %14s\n", "cost us", "workers", "batch/s", "single/s", "in process/s");
+
+    for (uint32_t cost : costs) {
+        auto evalFunc = [cost](const std::vector<double> & x) { return timedEvaluation(x, cost); };
+
+        // fewer single points for expensive evaluations, so every row takes
+        // about the same time
+        uint32_t singleCount = cost >= 100 ? batchCount / 10 : batchCount;
+
+        auto begin = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < batchCount; i++) {
+            values[i] = evalFunc(points[i]);
+        }
+        double inProcess = batchCount / seconds(begin);
+
+        // A Shutdown frame ends a worker, so every row starts its own workers
+        for (uint32_t count = 1; count <= maxWorkers; count++) {
+            std::vector<std::unique_ptr<NelderMeadFarmWorker>> workers;
+            std::vector<std::string> endpoints;
+            for (uint32_t w = 0; w < count; w++) {
+                workers.emplace_back(new NelderMeadFarmWorker(evalFunc));
+                if (!workers[w]->listen("tcp:127.0.0.1:0")) {
+                    printf("could not listen on 127.0.0.1\n");
+                    return 1;
+                }
+                workers[w]->start();
+                endpoints.push_back(workers[w]->getEndpoint());
+            }
+
+            NelderMeadEvalFarm farm(endpoints);
+            if (farm.getWorkerCount() != count) {
+                printf("could not connect to every worker\n");
+                return 1;
+            }
+
+            begin = std::chrono::steady_clock::now();
+            farm.evaluate(batchCount, pointers.data(), values.data());
+            double batch = batchCount / seconds(begin);
+
+            begin = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < singleCount; i++) {
+                values[i] = farm.evaluate(points[i]);
+            }
+            double single = singleCount / seconds(begin);
+
+            printf("%8u %8u %14.0f %14.0f %14.0f\n", cost, count, batch, single, inProcess);
+
+            farm.shutdown();
+            for (std::unique_ptr<NelderMeadFarmWorker> & worker : workers) {
+                worker->stop();
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Compares a direct search at full resolution with NelderMeadMultilevel on a
+// smoothed curve fit.
+//
+//     benchmark_multilevel [size ...]
+//
+// For each size, 32, 64, 128 and 256 by default, the variables are the
+// values of a curve at evenly spaced knots on [0, 1]. The objective is the
+// squared distance to sin(3 t) + t / 2 plus a tenth of the squared
+// differences of neighboring knots. Both searches start from zero with a
+// scale of 0.5 and a tolerance of 1e-9. The multilevel levels halve in size
+// down to 4 knots, with linear interpolation between the knots as both
+// prolongation and restriction. The evaluations, minimum and time of each are
+// printed.
+
+#include "nm_multilevel.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+
+// Linear interpolation of the curve through the knots of one grid at the
+// knots of another
+static void resample(const std::vector<double> & from, std::vector<double> & to)
+{
+    size_t n = from.size();
+    size_t m = to.size();
+    for (size_t i = 0; i < m; i++) {
+        double t = (double)i / (m - 1) * (n - 1);
+        size_t k = (size_t)t;
+        if (k >= n - 1) {
+            k = n - 2;
+        }
+        double w = t - k;
+        to[i] = from[k] * (1.0 - w) + from[k + 1] * w;
+    }
+}
+
+static double seconds(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int main(int argc, char ** argv)
+{
+    std::vector<uint32_t> sizes;
+    for (int i = 1; i < argc; i++) {
+        sizes.push_back((uint32_t)strtoul(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = { 32, 64, 128, 256 };
+    }
+
+    printf("%9s %12s %14s %10s %12s %14s %10s\n", "variables", "direct", "min", "seconds", "multilevel", "min", "seconds");
+
+    for (uint32_t size : sizes) {
+        if (size < 4) {
+            printf("%9u too small, needs at least 4 variables\n", size);
+            continue;
+        }
+
+        std::vector<double> target(size);
+        for (uint32_t i = 0; i < size; i++) {
+            double t = (double)i / (size - 1);
+            target[i] = sin(3.0 * t) + 0.5 * t;
+        }
+        auto evalFunc = [&](const std::vector<double> & x) {
+            double sum = 0.0;
+            for (uint32_t i = 0; i < size; i++) {
+                double d = x[i] - target[i];
+                sum += d * d;
+            }
+            for (uint32_t i = 0; i + 1 < size; i++) {
+                double d = x[i + 1] - x[i];
+                sum += 0.1 * d * d;
+            }
+            return sum;
+        };
+        std::vector<double> start(size, 0.0);
+
+        NelderMead direct(size, evalFunc, nullptr);
+        direct.setMaxIterations(2000000);
+        auto begin = std::chrono::steady_clock::now();
+        direct.exec(start, 1.0e-9, 0.5);
+        double directSeconds = seconds(begin);
+
+        // levels from 4 knots up, each about twice the one below
+        std::vector<uint32_t> levelSizes;
+        for (uint32_t n = size; ; n = (n + 1) / 2) {
+            levelSizes.insert(levelSizes.begin(), n);
+            if (n <= 4) {
+                break;
+            }
+        }
+        NelderMeadMultilevel multilevel(evalFunc);
+        for (uint32_t levelSize : levelSizes) {
+            NelderMeadLevel level;
+            level.size = levelSize;
+            if (levelSize != levelSizes[0]) {
+                level.prolongFunc = resample;
+                level.restrictFunc = resample;
+            }
+            multilevel.addLevel(level);
+        }
+        multilevel.setMaxIterations(2000000);
+        begin = std::chrono::steady_clock::now();
+        multilevel.exec(start, 1.0e-9, 0.5);
+        double multilevelSeconds = seconds(begin);
+
+        const NelderMeadResults & d = direct.getLastExecResults();
+        const NelderMeadResults & m = multilevel.getLastExecResults();
+        printf("%9u %12u %14.10f %10.3f %12u %14.10f %10.3f\n", size, d.evalCount, d.min, directSeconds,
+            m.evalCount, m.min, multilevelSeconds);
+    }
+    return 0;
+}
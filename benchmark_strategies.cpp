@@ -0,0 +1,105 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Counts the evaluations each step strategy needs to get close to the minimum.
+//
+//     benchmark_strategies [size ...]
+//
+// Each size, 2, 5 and 10 by default, is solved from 20 starts on the Rosenbrock
+// function and on a narrow diagonal valley, both with a minimum of 0. For each
+// strategy the program prints how many of the searches got within 1e-6 of the
+// minimum, and the mean number of evaluations those searches needed to get
+// there. A search counts the evaluations up to its first value below 1e-6,
+// not the ones it spent afterwards confirming convergence.
+
+#include "nm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+static const char * strategyNames[] = { "GreedyMinimization", "GreedyExpansion", "RepeatedExpansion", "InsideContractionOnly" };
+
+static double rosenbrock(const std::vector<double> & x)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i + 1 < x.size(); i++) {
+        double a = x[i + 1] - x[i] * x[i];
+        double b = 1.0 - x[i];
+        sum += 100.0 * a * a + b * b;
+    }
+    return sum;
+}
+
+// Steep across the diagonal x0 = x1 = ... and almost flat along it
+static double valley(const std::vector<double> & x)
+{
+    double sum = 1.0e-4 * x[0] * x[0];
+    for (size_t i = 1; i < x.size(); i++) {
+        double d = x[i] - x[0];
+        sum += 100.0 * d * d;
+    }
+    return sum;
+}
+
+int main(int argc, char ** argv)
+{
+    std::vector<uint32_t> sizes;
+    for (int i = 1; i < argc; i++) {
+        sizes.push_back((uint32_t)strtoul(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = { 2, 5, 10 };
+    }
+
+    struct Problem {
+        const char * name;
+        double (*func)(const std::vector<double>&);
+        double start;
+    };
+    const Problem problems[] = { { "rosenbrock", rosenbrock, -1.2 }, { "valley", valley, 50.0 } };
+    const double target = 1.0e-6;
+    const int starts = 20;
+
+    printf("%-10s %4s %-22s %7s %14s\n", "objective", "size", "strategy", "reached", "mean evals");
+
+    for (const Problem & problem : problems) {
+        for (uint32_t size : sizes) {
+            for (int s = 0; s < 4; s++) {
+                uint64_t evaluations = 0;
+                int reached = 0;
+
+                for (int r = 0; r < starts; r++) {
+                    uint32_t count = 0;
+                    uint32_t toTarget = 0;
+                    NelderMead solver(size, [&](const std::vector<double> & x) {
+                        double value = problem.func(x);
+                        count++;
+                        if (toTarget == 0 && value < target) {
+                            toTarget = count;
+                        }
+                        return value;
+                    }, nullptr);
+                    solver.setMaxIterations(200000);
+                    solver.setStrategy((NelderMeadStrategy)s);
+
+                    std::vector<double> start(size, problem.start);
+                    start[0] += 0.1 * r;
+                    solver.exec(start, 1.0e-14, 1.0);
+
+                    if (toTarget > 0) {
+                        reached++;
+                        evaluations += toTarget;
+                    }
+                }
+
+                printf("%-10s %4u %-22s %4d/%-2d %14.0f\n", problem.name, size, strategyNames[s], reached, starts,
+                    reached > 0 ? (double)evaluations / reached : 0.0);
+            }
+        }
+    }
+    return 0;
+}
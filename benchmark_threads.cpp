@@ -0,0 +1,75 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Times a fixed number of iterations of large problems across thread counts.
+//
+//     benchmark_threads [size ...]
+//
+// The default size is 10000. The simplex holds size + 1 points of size
+// doubles, so a size of 100000 needs 80 GB of memory.
+
+#include "nm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <thread>
+
+
+static double weightedQuadratic(const std::vector<double> & x)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < x.size(); i++) {
+        sum += (i % 7 + 1) * (x[i] - 0.5) * (x[i] - 0.5);
+    }
+    return sum;
+}
+
+int main(int argc, char ** argv)
+{
+    std::vector<uint32_t> sizes;
+    for (int i = 1; i < argc; i++) {
+        sizes.push_back((uint32_t)strtoul(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes.push_back(10000);
+    }
+
+    uint32_t cores = std::thread::hardware_concurrency();
+    std::vector<uint32_t> threadCounts = { 1 };
+    for (uint32_t t = 2; t <= cores; t *= 2) {
+        threadCounts.push_back(t);
+    }
+    if (cores > 1 && threadCounts.back() != cores) {
+        threadCounts.push_back(cores);
+    }
+
+    const uint32_t iterations = 200;
+    printf("%10s %8s %12s %12s %10s\n", "size", "threads", "seconds", "evaluations", "speedup");
+
+    for (uint32_t size : sizes) {
+        NelderMead solver(size, weightedQuadratic, nullptr);
+        solver.setMaxIterations(iterations);
+
+        double single = 0.0;
+        for (uint32_t threads : threadCounts) {
+            solver.setThreadCount(threads);
+
+            auto begin = std::chrono::steady_clock::now();
+            solver.exec(std::vector<double>(size, 0.0), 0.0, 1.0);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+            if (threads == 1) {
+                single = seconds;
+            }
+            printf("%10u %8u %12.3f %12u %9.2fx\n", size, threads, seconds,
+                solver.getLastExecResults().evalCount, single / seconds);
+        }
+    }
+    return 0;
+}
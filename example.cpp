@@ -6,6 +6,7 @@
  **********************************************************************/
 
 #include "nm.h"
+#include "nm_fixed.h"
 
 #include <math.h>
 #include <stdio.h>
@@ -38,6 +39,24 @@ void myConstraints(std::vector<double>& x)
     }
 }
 
+// A small calibration over an embedded table, fitted at compile time. The
+// table was generated from y = 0.5 + 2 * t. tests/fixed.cpp checks this and
+// larger compile-time fits with static_assert.
+constexpr std::array<double, 5> tableT = { 0.0, 1.0, 2.0, 3.0, 4.0 };
+constexpr std::array<double, 5> tableY = { 0.5, 2.5, 4.5, 6.5, 8.5 };
+
+constexpr double lineError(const std::array<double, 2> & x)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < tableT.size(); i++) {
+        double r = x[0] + x[1] * tableT[i] - tableY[i];
+        sum += r * r;
+    }
+    return sum;
+}
+
+constexpr auto lineFit = fixedNelderMead<2>(lineError, std::array<double, 2>{ 0.0, 0.0 }, 1.0e-14, 1.0);
+
 void printResults(const NelderMeadResults& results)
 {
     printf("    %u Function Evaluations\n", results.evalCount);
@@ -63,5 +82,9 @@ int main()
     simp->exec(std::vector<double>{ 1, 1 }, 1.0e-12, 1.0);
     printResults(simp->getLastExecResults());
 
+    fprintf(stdout, "Line fitted at compile time\n");
+    fprintf(stdout, "    %u Function Evaluations\n", lineFit.evalCount);
+    fprintf(stdout, "    Intercept %le, slope %le\n", lineFit.minValues[0], lineFit.minValues[1]);
+
     return 0;
 }
@@ -0,0 +1,444 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#include "cmaes.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+// Eigen decomposition of the symmetric n by n matrix a by cyclic Jacobi
+// rotations. a is destroyed, its eigenvalues end up in values and the
+// matching eigenvectors in the columns of vectors.
+static void jacobiEigen(uint32_t n, std::vector<double> & a, std::vector<double> & vectors, std::vector<double> & values)
+{
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+            vectors[i * n + j] = i == j ? 1.0 : 0.0;
+        }
+    }
+
+    for (int sweep = 0; sweep < 64; sweep++) {
+        double off = 0.0;
+        double diagonal = 0.0;
+        for (uint32_t p = 0; p < n; p++) {
+            diagonal += a[p * n + p] * a[p * n + p];
+            for (uint32_t q = p + 1; q < n; q++) {
+                off += a[p * n + q] * a[p * n + q];
+            }
+        }
+        if (off <= 1.0e-30 * diagonal) {
+            break;
+        }
+
+        for (uint32_t p = 0; p < n; p++) {
+            for (uint32_t q = p + 1; q < n; q++) {
+                double apq = a[p * n + q];
+                if (apq == 0.0) {
+                    continue;
+                }
+
+                // rotation that zeroes a[p][q]
+                double theta = (a[q * n + q] - a[p * n + p]) / (2.0 * apq);
+                double t = (theta >= 0.0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+                double cosine = 1.0 / sqrt(t * t + 1.0);
+                double sine = t * cosine;
+
+                for (uint32_t k = 0; k < n; k++) {
+                    double akp = a[k * n + p];
+                    double akq = a[k * n + q];
+                    a[k * n + p] = cosine * akp - sine * akq;
+                    a[k * n + q] = sine * akp + cosine * akq;
+                }
+                for (uint32_t k = 0; k < n; k++) {
+                    double apk = a[p * n + k];
+                    double aqk = a[q * n + k];
+                    a[p * n + k] = cosine * apk - sine * aqk;
+                    a[q * n + k] = sine * apk + cosine * aqk;
+                }
+                for (uint32_t k = 0; k < n; k++) {
+                    double vkp = vectors[k * n + p];
+                    double vkq = vectors[k * n + q];
+                    vectors[k * n + p] = cosine * vkp - sine * vkq;
+                    vectors[k * n + q] = sine * vkp + cosine * vkq;
+                }
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        values[i] = a[i * n + i];
+    }
+}
+
+
+CmaEs::CmaEs(
+    uint32_t inSize,
+    const std::function<double(const std::vector<double>&)> & inEvalFunc,
+    const std::function<void(std::vector<double>&)> & inConstrainFunc
+)
+{
+    size = inSize;
+    evalFunc = inEvalFunc;
+    constrainFunc = inConstrainFunc;
+
+    mean.resize(size);
+    oldMean.resize(size);
+    pc.resize(size);
+    ps.resize(size);
+    c.resize(size * size);
+    b.resize(size * size);
+    d.resize(size);
+    z.resize(size);
+    work.resize(size * size);
+    rotation.resize(size * size);
+}
+
+CmaEs::~CmaEs()
+{
+}
+
+
+void CmaEs::setThreadCount(uint32_t inValue)
+{
+    if (inValue <= 1) {
+        pool.reset();
+    }
+    else if (!pool || pool->getThreadCount() != inValue) {
+        pool.reset(new NelderMeadThreadPool(inValue));
+    }
+}
+
+void CmaEs::doSetup(uint32_t populationSize, const std::vector<double> & start, double scale)
+{
+    double n = size;
+
+    // selection and recombination
+    lambda = populationSize < 2 ? 2 : populationSize;
+    mu = lambda / 2;
+    weights.resize(mu);
+    double sum = 0.0;
+    for (uint32_t i = 0; i < mu; i++) {
+        weights[i] = log(mu + 0.5) - log(i + 1.0);
+        sum += weights[i];
+    }
+    double squares = 0.0;
+    for (auto & w : weights) {
+        w /= sum;
+        squares += w * w;
+    }
+    mueff = 1.0 / squares;
+
+    // adaptation
+    cc = (4.0 + mueff / n) / (n + 4.0 + 2.0 * mueff / n);
+    cs = (mueff + 2.0) / (n + mueff + 5.0);
+    c1 = 2.0 / ((n + 1.3) * (n + 1.3) + mueff);
+    cmu = std::min(1.0 - c1, 2.0 * (mueff - 2.0 + 1.0 / mueff) / ((n + 2.0) * (n + 2.0) + mueff));
+    damps = 1.0 + 2.0 * std::max(0.0, sqrt((mueff - 1.0) / (n + 1.0)) - 1.0) + cs;
+    chiN = sqrt(n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+
+    // initial distribution
+    for (uint32_t i = 0; i < size; i++) {
+        mean[i] = start[i];
+        pc[i] = 0.0;
+        ps[i] = 0.0;
+        d[i] = 1.0;
+        for (uint32_t j = 0; j < size; j++) {
+            c[i * size + j] = i == j ? 1.0 : 0.0;
+            b[i * size + j] = i == j ? 1.0 : 0.0;
+        }
+    }
+    sigma = scale;
+    eigenEval = evalCount;
+
+    population.resize(lambda);
+    for (auto & x : population) {
+        x.resize(size);
+    }
+    pending.resize(lambda);
+    for (uint32_t k = 0; k < lambda; k++) {
+        pending[k] = &population[k];
+    }
+    values.resize(lambda);
+    order.resize(lambda);
+    history.assign(10 + (30 * size + lambda - 1) / lambda, 0.0);
+}
+
+void CmaEs::doDecompose()
+{
+    // In the basis of the last decomposition C is nearly diagonal, so Jacobi
+    // only needs a sweep or two: decompose B^T C B and rotate B by the result
+    for (uint32_t i = 0; i < size; i++) {
+        for (uint32_t j = 0; j < size; j++) {
+            double sum = 0.0;
+            for (uint32_t k = 0; k < size; k++) {
+                sum += c[i * size + k] * b[k * size + j];
+            }
+            rotation[i * size + j] = sum;
+        }
+    }
+    for (uint32_t i = 0; i < size; i++) {
+        for (uint32_t j = i; j < size; j++) {
+            double sum = 0.0;
+            for (uint32_t k = 0; k < size; k++) {
+                sum += b[k * size + i] * rotation[k * size + j];
+            }
+            work[i * size + j] = sum;
+            work[j * size + i] = sum;
+        }
+    }
+
+    jacobiEigen(size, work, rotation, d);
+
+    for (uint32_t i = 0; i < size; i++) {
+        const double * row = &b[i * size];
+        for (uint32_t j = 0; j < size; j++) {
+            double sum = 0.0;
+            for (uint32_t k = 0; k < size; k++) {
+                sum += row[k] * rotation[k * size + j];
+            }
+            z[j] = sum;
+        }
+        for (uint32_t j = 0; j < size; j++) {
+            b[i * size + j] = z[j];
+        }
+    }
+
+    for (auto & value : d) {
+        value = sqrt(value > 1.0e-300 ? value : 1.0e-300);
+    }
+    eigenEval = evalCount;
+}
+
+void CmaEs::doEvaluate()
+{
+    if (batchEvalFunc) {
+        batchEvalFunc(lambda, pending.data(), values.data());
+    }
+    else if (pool) {
+        pool->run(lambda, [this](uint32_t k) {
+            values[k] = evalFunc(population[k]);
+        });
+    }
+    else {
+        for (uint32_t k = 0; k < lambda; k++) {
+            values[k] = evalFunc(population[k]);
+        }
+    }
+    evalCount += lambda;
+
+    for (uint32_t k = 0; k < lambda; k++) {
+        if (values[k] < lastExecResults.min) {
+            lastExecResults.min = values[k];
+            lastExecResults.minValues = population[k];
+        }
+    }
+}
+
+bool CmaEs::doGeneration(uint32_t generation, double tolerance, double scale)
+{
+    // sample x = mean + sigma * B * D * z, then constrain it
+    for (uint32_t k = 0; k < lambda; k++) {
+        for (uint32_t j = 0; j < size; j++) {
+            z[j] = d[j] * normal(random);
+        }
+        std::vector<double> & x = population[k];
+        for (uint32_t i = 0; i < size; i++) {
+            const double * row = &b[i * size];
+            double step = 0.0;
+            for (uint32_t j = 0; j < size; j++) {
+                step += row[j] * z[j];
+            }
+            x[i] = mean[i] + sigma * step;
+        }
+        if (constrainFunc) {
+            constrainFunc(x);
+        }
+    }
+
+    doEvaluate();
+
+    for (uint32_t k = 0; k < lambda; k++) {
+        order[k] = k;
+    }
+    // NaN values are ordered last, so the comparison stays a strict weak ordering
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t l, uint32_t r) {
+        bool lNan = values[l] != values[l];
+        bool rNan = values[r] != values[r];
+        if (lNan || rNan) {
+            return !lNan && rNan;
+        }
+        return values[l] < values[r];
+    });
+
+    // move the mean to the weighted average of the best mu points
+    oldMean.swap(mean);
+    for (uint32_t i = 0; i < size; i++) {
+        double sum = 0.0;
+        for (uint32_t k = 0; k < mu; k++) {
+            sum += weights[k] * population[order[k]][i];
+        }
+        mean[i] = sum;
+    }
+
+    // step size path, with the mean shift whitened by C^-1/2 = B D^-1 B^T
+    for (uint32_t j = 0; j < size; j++) {
+        double sum = 0.0;
+        for (uint32_t i = 0; i < size; i++) {
+            sum += b[i * size + j] * (mean[i] - oldMean[i]);
+        }
+        z[j] = sum / sigma / d[j];
+    }
+    double psNorm = 0.0;
+    double psScale = sqrt(cs * (2.0 - cs) * mueff);
+    for (uint32_t i = 0; i < size; i++) {
+        const double * row = &b[i * size];
+        double sum = 0.0;
+        for (uint32_t j = 0; j < size; j++) {
+            sum += row[j] * z[j];
+        }
+        ps[i] = (1.0 - cs) * ps[i] + psScale * sum;
+        psNorm += ps[i] * ps[i];
+    }
+    psNorm = sqrt(psNorm);
+
+    // covariance path, stalled while the step size path is long
+    bool hsig = psNorm / sqrt(1.0 - pow(1.0 - cs, 2.0 * (generation + 1))) / chiN < 1.4 + 2.0 / (size + 1.0);
+    double pcScale = hsig ? sqrt(cc * (2.0 - cc) * mueff) : 0.0;
+    for (uint32_t i = 0; i < size; i++) {
+        pc[i] = (1.0 - cc) * pc[i] + pcScale * (mean[i] - oldMean[i]) / sigma;
+    }
+
+    // rank one and rank mu updates of the upper triangle, mirrored below
+    double keep = 1.0 - c1 - cmu + (hsig ? 0.0 : c1 * cc * (2.0 - cc));
+    for (uint32_t i = 0; i < size; i++) {
+        for (uint32_t j = i; j < size; j++) {
+            double rankMu = 0.0;
+            for (uint32_t k = 0; k < mu; k++) {
+                const std::vector<double> & x = population[order[k]];
+                rankMu += weights[k] * (x[i] - oldMean[i]) * (x[j] - oldMean[j]);
+            }
+            double value = keep * c[i * size + j] + c1 * pc[i] * pc[j] + cmu * rankMu / (sigma * sigma);
+            c[i * size + j] = value;
+            c[j * size + i] = value;
+        }
+    }
+
+    sigma *= exp((cs / damps) * (psNorm / chiN - 1.0));
+
+    // The decomposition costs O(size^3), so it is only redone once C has
+    // moved enough for it to matter
+    if (evalCount - eigenEval > lambda / (c1 + cmu) / size / 10.0) {
+        doDecompose();
+    }
+
+    // test for the end of the run
+    if (lastExecResults.min <= configTargetValue || evalCount >= configMaxEvaluations || !(sigma > 0.0) || !isfinite(sigma)) {
+        return false;
+    }
+
+    double best = values[order[0]];
+    history[generation % history.size()] = best;
+    double low = best;
+    double high = values[order[lambda - 1]];
+    if (generation + 1 >= history.size()) {
+        for (double h : history) {
+            low = std::min(low, h);
+            high = std::max(high, h);
+        }
+        if (high - low < tolerance) {
+            return false;
+        }
+    }
+
+    double minD = d[0];
+    double maxD = d[0];
+    for (double value : d) {
+        minD = std::min(minD, value);
+        maxD = std::max(maxD, value);
+    }
+    if (sigma * maxD < 1.0e-12 * scale || maxD > 1.0e7 * minD) {
+        return false;
+    }
+    return true;
+}
+
+uint32_t CmaEs::doRun(uint32_t populationSize, const std::vector<double> & start, double tolerance, double scale)
+{
+    uint32_t before = evalCount;
+
+    doSetup(populationSize, start, scale);
+    runCount++;
+    for (uint32_t generation = 0; generation < configMaxIterations; generation++) {
+        iterationCount++;
+        if (!doGeneration(generation, tolerance, scale)) {
+            break;
+        }
+    }
+    return evalCount - before;
+}
+
+void CmaEs::exec(const std::vector<double> & inStart, double tolerance, double scale)
+{
+    // the default population size takes the log of the size
+    if (size == 0) {
+        throw std::invalid_argument("CmaEs: a search needs at least one variable");
+    }
+    if (inStart.size() != size) {
+        throw std::invalid_argument("CmaEs: the start point must have as many values as the search has variables");
+    }
+
+    // This function can be called many times for the same instance of the class
+    // so we have to initialize it every time.
+    random.seed(configSeed);
+    normal.reset();
+    evalCount = 0;
+    iterationCount = 0;
+    runCount = 0;
+    lastExecResults.min = HUGE_VAL;
+    lastExecResults.minValues = inStart;
+
+    uint32_t defaultLambda = configPopulationSize > 0 ? configPopulationSize : 4 + (uint32_t)(3.0 * log((double)size));
+    uint32_t largeLambda = defaultLambda;
+    uint64_t largeEvals = doRun(defaultLambda, inStart, tolerance, scale);
+    uint64_t smallEvals = 0;
+
+    if (configRestart != CmaEsRestart::None) {
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::vector<double> restartStart(size);
+
+        for (uint32_t restart = 0; restart < configMaxRestarts; restart++) {
+            if (evalCount >= configMaxEvaluations || lastExecResults.min <= configTargetValue) {
+                break;
+            }
+
+            // each restart starts from a new mean, drawn uniformly within
+            // scale of the start
+            for (uint32_t i = 0; i < size; i++) {
+                restartStart[i] = inStart[i] + scale * (2.0 * unit(random) - 1.0);
+            }
+            if (constrainFunc) {
+                constrainFunc(restartStart);
+            }
+
+            if (configRestart == CmaEsRestart::Bipop && smallEvals < largeEvals) {
+                // a small population, between the default and half the current
+                // large one, with a step size down to a hundredth of the start
+                double u = unit(random);
+                uint32_t smallLambda = (uint32_t)(defaultLambda * pow(0.5 * largeLambda / defaultLambda, u * u));
+                smallEvals += doRun(smallLambda, restartStart, tolerance, scale * pow(10.0, -2.0 * u));
+            }
+            else {
+                largeLambda *= 2;
+                largeEvals += doRun(largeLambda, restartStart, tolerance, scale);
+            }
+        }
+    }
+
+    lastExecResults.evalCount = evalCount;
+    lastExecResults.iterationCount = iterationCount;
+}
@@ -0,0 +1,147 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#pragma once
+
+// system headers
+#include <math.h>
+#include <stdint.h>
+
+// std library headers
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+// project headers
+#include "nm.h"
+
+
+// What CmaEs does once a run has converged or stalled. Every restart starts from
+// a new mean, drawn uniformly within scale of the start.
+enum class CmaEsRestart {
+    None,       // a single run
+    Ipop,       // restart with the population size doubled each time
+    Bipop       // alternate between doubling populations and small populations with
+                // a random, smaller step size, giving each regime a similar budget
+};
+
+// Covariance matrix adaptation evolution strategy (Hansen). It is a companion to
+// NelderMead for larger and rugged problems and is used the same way: construct it
+// with the number of variables, an evaluation function and a constraint function,
+// call exec and read getLastExecResults. Every generation samples a population of
+// points, which are evaluated in a single batch: by the batch evaluation function
+// if one is set, otherwise on the thread pool if there is one, otherwise one after
+// the other. With a thread count above one the evaluation function is called from
+// several threads at once.
+//
+// exec's scale is the initial step size. A run ends when the values of a
+// generation, and the best values of recent generations, lie within tolerance of
+// each other, when the step size has collapsed, or at the generation limit. The
+// results are those of the best point evaluated over all runs; iterationCount is
+// the number of generations.
+//
+// Points are drawn from a generator seeded by setSeed, so a search is repeatable
+// whatever the number of threads.
+class CmaEs
+{
+    public:
+        // Constructors and destructor
+
+        CmaEs(
+            uint32_t inSize,
+            const std::function<double(const std::vector<double>&)> &,
+            const std::function<void(std::vector<double>&)> &
+        );
+        ~CmaEs();
+
+        // public methods
+
+        // Throws std::invalid_argument if the search has no variables or the start
+        // point is not of its size
+        void exec(const std::vector<double> & inStart, double tolerance, double scale);
+        const NelderMeadResults & getLastExecResults() const { return lastExecResults; }
+        uint32_t getRunCount() const { return runCount; }
+
+        // Same signature, and same use, as the batch evaluation function of NelderMead
+        void setBatchEvalFunc(const std::function<void(uint32_t, const std::vector<double>* const*, double*)> & inFunc) { batchEvalFunc = inFunc; }
+
+        void setThreadCount(uint32_t inValue);
+        void setSeed(uint64_t inValue) { configSeed = inValue; }
+        void setMaxIterations(uint32_t inValue) { configMaxIterations = inValue; }
+        void setMaxEvaluations(uint32_t inValue) { configMaxEvaluations = inValue; }
+        void setPopulationSize(uint32_t inValue) { configPopulationSize = inValue; }
+        void setRestart(CmaEsRestart inValue) { configRestart = inValue; }
+        void setMaxRestarts(uint32_t inValue) { configMaxRestarts = inValue; }
+        void setTargetValue(double inValue) { configTargetValue = inValue; }
+
+
+    private:
+        // Configuration values that can be modified by the user prior to an exec call
+
+        uint64_t configSeed = 1;
+        uint32_t configMaxIterations = 10000;       // generations per run
+        uint32_t configMaxEvaluations = 1000000;    // over all runs
+        uint32_t configPopulationSize = 0;          // 0 for 4 + 3 ln(size)
+        CmaEsRestart configRestart = CmaEsRestart::None;
+        uint32_t configMaxRestarts = 9;
+        double configTargetValue = -HUGE_VAL;       // stop once a value this low is found
+
+        std::unique_ptr<NelderMeadThreadPool> pool;
+
+        // Core definition of an instantiation of the algorithm
+
+        uint32_t size = 0;
+        std::function<double(const std::vector<double>&)> evalFunc;
+        std::function<void(std::vector<double>&)> constrainFunc;
+        std::function<void(uint32_t, const std::vector<double>* const*, double*)> batchEvalFunc;
+
+        // State of the current run. Matrices are size by size, row major.
+
+        uint32_t lambda = 0;        // population size
+        uint32_t mu = 0;            // number of parents
+        std::vector<double> weights;
+        double mueff = 0.0;
+        double cc = 0.0, cs = 0.0, c1 = 0.0, cmu = 0.0, damps = 0.0, chiN = 0.0;
+
+        std::vector<double> mean;
+        std::vector<double> oldMean;
+        double sigma = 0.0;
+        std::vector<double> pc;         // evolution path of the covariance
+        std::vector<double> ps;         // evolution path of the step size
+        std::vector<double> c;          // covariance matrix
+        std::vector<double> b;          // its eigenvectors, as columns
+        std::vector<double> d;          // and the square roots of its eigenvalues
+        uint32_t eigenEval = 0;         // evaluation count at the last decomposition
+
+        std::vector<std::vector<double>> population;
+        std::vector<const std::vector<double>*> pending;
+        std::vector<double> values;
+        std::vector<uint32_t> order;
+        std::vector<double> z;          // a standard normal sample
+        std::vector<double> work;
+        std::vector<double> rotation;
+        std::vector<double> history;    // best value of recent generations, as a ring
+
+        std::mt19937_64 random;
+        std::normal_distribution<double> normal;
+
+        // Execution state over all runs. Reset on every exec call.
+
+        uint32_t evalCount = 0;
+        uint32_t iterationCount = 0;
+        uint32_t runCount = 0;
+        NelderMeadResults lastExecResults;
+
+        // private methods
+
+        void doSetup(uint32_t populationSize, const std::vector<double> & start, double scale);
+        void doDecompose();
+        void doEvaluate();
+        bool doGeneration(uint32_t generation, double tolerance, double scale);
+        uint32_t doRun(uint32_t populationSize, const std::vector<double> & start, double tolerance, double scale);
+};
@@ -17,8 +17,13 @@
 
 // std library headers
 #include <functional>
+#include <memory>
 #include <vector>
 
+// project headers
+#include "nm_policies.h"
+#include "nm_pool.h"
+
 // Set to 1 to enable debug output
 #define NELDER_MEAD_DEBUG 0
 
@@ -31,28 +36,158 @@ struct NelderMeadResults {
     double min;
 };
 
+// Passed to an evaluation function that wants to know where a point came from.
+// Every point the solver evaluates gets a new id, starting at 1, that is never
+// reused by the same solver. parentId is the id of the already evaluated point
+// the new one is expected to be closest to, or 0 for the points of the initial
+// simplex, which have none. An objective that keeps some inner state per point
+// can warm start from the state of the parent, and drop the state of a point
+// once its id has been retired.
+struct NelderMeadEvalContext {
+    uint64_t pointId;
+    uint64_t parentId;
+};
+
+// How an iteration chooses between its trial points. All of them start with a
+// reflection of the worst vertex through the centroid of the others.
+enum class NelderMeadStrategy {
+    GreedyMinimization,     // an expansion is kept only if it beats the reflection
+    GreedyExpansion,        // an expansion is kept if it beats the best vertex (Lagarias et al.)
+    RepeatedExpansion,      // a successful expansion is pushed further, by the expansion
+                            // growth factor, until it stops improving
+    InsideContractionOnly   // as GreedyMinimization, but contractions are always inside
+};
+
 // Main interface for the Nelder-Mead algorithm. Once constructed, the number of variables
 // being solved for cannot be changed.
-class NelderMead
+//
+// The ordering of the vertices, the centroid computation, the convergence test, the
+// constraint handling, the per iteration callback and the instrumentation are chosen
+// at compile time by Policies (see nm_policies.h). NelderMead is the instantiation
+// with the default policies.
+template <typename Policies>
+class BasicNelderMead
 {
     public:
+        using Ordering = typename Policies::Ordering;
+        using Centroid = typename Policies::Centroid;
+        using Convergence = typename Policies::Convergence;
+        using Constraint = typename Policies::Constraint;
+        using Callback = typename Policies::Callback;
+        using Instrumentation = typename Policies::Instrumentation;
+
+        // Number of vector elements, and of simplex rows, handed to a thread at a time
+        // by the parallel kernels. Reductions are summed in blocks of elementChunk.
+        static const uint32_t elementChunk = 4096;
+        static const uint32_t rowChunk = 16;
+
+        // A repeated expansion stops after this many further steps even if it is
+        // still improving, which keeps an objective unbounded below from running away
+        static const uint32_t maxExpansions = 32;
+
         // Constructors and destructor
 
-        NelderMead(
+        BasicNelderMead(
             uint32_t inSize,
             const std::function<double(const std::vector<double>&)> &,
-            const std::function<void(std::vector<double>&)> &
+            const Constraint & = Constraint(),
+            const Callback & = Callback(),
+            const Instrumentation & = Instrumentation()
         );
-        ~NelderMead();
+        ~BasicNelderMead();
 
         // public methods
 
         void exec(const std::vector<double> & inStart, double tolerance, double scale);
+
+        // As above, but the search starts from the given simplex of size + 1 vertices
+        // rather than from one built around a start point
+        void exec(const std::vector<std::vector<double>> & inSimplex, double tolerance);
         const NelderMeadResults & getLastExecResults() const { return lastExecResults; }
+
+        // Ask/tell interface. exec is the same as calling start and then, until isDone
+        // returns true, evaluating the pending points and passing their values to tell.
+        // This lets the caller evaluate the points itself, in whatever way it likes.
+        // Once done, the results are available from getLastExecResults.
+
+        void start(const std::vector<double> & inStart, double tolerance, double scale);
+        void start(const std::vector<std::vector<double>> & inSimplex, double tolerance);
+        bool isDone() const { return phase == Phase::Done; }
+        uint32_t getPendingCount() const { return pendingCount; }
+        const std::vector<double> & getPendingPoint(uint32_t i) const { return *pending[i]; }
+        uint64_t getPendingId(uint32_t i) const { return pendingContext[i].pointId; }
+        uint64_t getPendingParentId(uint32_t i) const { return pendingContext[i].parentId; }
+        void tell(const double * values);
+
+        // When set, exec passes all the pending points to this function in a single
+        // call rather than calling the evaluation function once for each. Several
+        // points are pending while the initial simplex and a shrunk simplex are
+        // evaluated.
+        void setBatchEvalFunc(const std::function<void(uint32_t, const std::vector<double>* const*, double*)> & inFunc) { batchEvalFunc = inFunc; }
+
+        // When set, exec evaluates points with this function instead, passing the
+        // id of each point and of its parent (see NelderMeadEvalContext). The retire
+        // function is called with the id of every point the search no longer holds:
+        // vertices when they are replaced, trial points that were not accepted, and
+        // everything that is left once the search is complete.
+        void setContextEvalFunc(const std::function<double(const std::vector<double>&, const NelderMeadEvalContext&)> & inFunc) { contextEvalFunc = inFunc; }
+        void setRetireFunc(const std::function<void(uint64_t)> & inFunc) { retireFunc = inFunc; }
+
+        // The batch form of the context evaluation function, which gets one context
+        // for each point. When set, exec passes it every batch of several points,
+        // and single points as well unless a context evaluation function is set.
+        void setBatchContextEvalFunc(const std::function<void(uint32_t, const std::vector<double>* const*, const NelderMeadEvalContext*, double*)> & inFunc) { batchContextEvalFunc = inFunc; }
+
         void setMaxIterations(uint32_t inValue) { configMaxIterations = inValue; }
         void setReflectionCoefficient(double inValue) { configReflectionCoefficient = inValue; }
         void setContractionCoefficient(double inValue) { configContractionCoefficient = inValue; }
         void setExpansionCoefficient(double inValue) { configExpansionCoefficient = inValue; }
+        void setStrategy(NelderMeadStrategy inValue) { configStrategy = inValue; }
+        void setExpansionGrowth(double inValue) { configExpansionGrowth = inValue; }
+        void setThreadCount(uint32_t inValue);
+        void setParallelThreshold(uint32_t inValue) { configParallelThreshold = inValue; }
+
+        Constraint & getConstraint() { return constraint; }
+        Callback & getCallback() { return callback; }
+        Instrumentation & getInstrumentation() { return instrumentation; }
+
+        // Read access to the state of the search, for use by policies
+
+        uint32_t getSize() const { return size; }
+        const std::vector<std::vector<double>> & getVertices() const { return v; }
+        const std::vector<double> & getValues() const { return f; }
+        uint32_t getBestIndex() const { return vs; }
+        uint32_t getNextIndex() const { return vh; }
+        uint32_t getWorstIndex() const { return vg; }
+        uint32_t getIterationCount() const { return iterationCount; }
+        uint32_t getEvalCount() const { return evalCount; }
+        bool isParallelSize() const { return size >= configParallelThreshold; }
+
+        // Runs func(begin, end) over [0, count) in chunks of chunkSize, on the
+        // thread pool when the problem is large enough to be worth it.
+        template <typename Func>
+        void forRange(uint32_t count, uint32_t chunkSize, const Func& func) const
+        {
+            if (!pool || !isParallelSize() || count <= chunkSize) {
+                func(0, count);
+                return;
+            }
+            doParallelRange(count, chunkSize, &callRange<Func>, &func);
+        }
+
+        // Runs func(block) for every block in [0, blocks), on the thread pool
+        // if there is one.
+        template <typename Func>
+        void forBlocks(uint32_t blocks, const Func& func) const
+        {
+            if (pool) {
+                doParallelBlocks(blocks, &callBlock<Func>, &func);
+                return;
+            }
+            for (uint32_t b = 0; b < blocks; b++) {
+                func(b);
+            }
+        }
 
 
     private:
@@ -62,6 +197,17 @@ class NelderMead
         double configReflectionCoefficient = 1.0;
         double configContractionCoefficient = 0.5;
         double configExpansionCoefficient = 2.0;
+        NelderMeadStrategy configStrategy = NelderMeadStrategy::GreedyMinimization;
+        double configExpansionGrowth = 2.0;
+
+        // The vector kernels of an iteration (centroid, trial points, copies,
+        // shrink and the convergence test) are split across threads once the
+        // problem has at least configParallelThreshold variables. Reductions
+        // above the threshold are always summed in fixed size blocks, in block
+        // order, so the results do not depend on the number of threads.
+
+        uint32_t configParallelThreshold = 8192;
+        std::unique_ptr<NelderMeadThreadPool> pool;
 
         // Core definition of an instantiation of the algorithm. These
         // values are set at construction time and cannot be modified 
@@ -70,7 +216,10 @@ class NelderMead
 
         uint32_t size = 0;
         std::function<double(const std::vector<double>&)> evalFunc;
-        std::function<void(std::vector<double>&)> constrainFunc;
+        std::function<void(uint32_t, const std::vector<double>* const*, double*)> batchEvalFunc;
+        std::function<double(const std::vector<double>&, const NelderMeadEvalContext&)> contextEvalFunc;
+        std::function<void(uint32_t, const std::vector<double>* const*, const NelderMeadEvalContext*, double*)> batchContextEvalFunc;
+        std::function<void(uint64_t)> retireFunc;
 
         std::vector<std::vector<double>> v;     // holds vertices of simplex 
         std::vector<double> f;      // value of function at each vertex 
@@ -79,9 +228,64 @@ class NelderMead
         std::vector<double> vc;     // contraction - coordinates 
         std::vector<double> vm;     // centroid - coordinates 
 
+        // Policy instances
+
+        Centroid centroid;
+        Convergence convergence;
+        Constraint constraint;
+        Callback callback;
+        Instrumentation instrumentation;
+
         // Current execution state. Reset on every exec call.
 
+        // The point in an iteration at which the search is waiting for values
+        enum class Phase {
+            Initial,        // all vertices of the initial simplex
+            Reflect,        // vr
+            Expand,         // ve
+            Contract,       // vc
+            ShrinkAll,      // all vertices of the shrunk simplex
+            ShrinkWorst,    // v[vg] once constrained
+            ShrinkNext,     // v[vh] once constrained
+            Final,          // v[vs], the reported minimum
+            Done
+        };
+
+        Phase phase = Phase::Done;
+        std::vector<const std::vector<double>*> pending;    // points waiting for values
+        std::vector<NelderMeadEvalContext> pendingContext;  // their ids, and those of their parents
+        uint32_t pendingCount = 0;
+        std::vector<double> pendingValues;  // values of the pending points, used by exec
+        double tolerance = 0.0;
+
+        // The configuration as it was when the search started, so that changes
+        // made during an ask/tell search only apply to the next one
+        uint32_t maxIterations = 1000;
+        double reflectionCoefficient = 1.0;
+        double contractionCoefficient = 0.5;
+        double expansionCoefficient = 2.0;
+        NelderMeadStrategy strategy = NelderMeadStrategy::GreedyMinimization;
+        double expansionGrowth = 2.0;
+
+        double fr = 0.0;        // value of function at reflection point
+        NelderMeadStep contraction = NelderMeadStep::OutsideContraction;
+        uint32_t expansionCount = 0;    // expansions made so far in this iteration
+
+        // Point ids. Ids keep counting up across exec calls. exec only keeps
+        // track of them when something can see them, a context evaluation, a
+        // batch context evaluation or a retire function; start always does.
+        bool trackIds = true;
+        uint64_t nextPointId = 1;
+        std::vector<uint64_t> vertexId;     // id of the point held by each vertex
+        std::vector<uint64_t> shrunkId;     // ids of the vertices before a shrink
+        uint64_t vrId = 0;
+        uint64_t veId = 0;
+        uint64_t vcId = 0;
+        uint64_t trialIds[3] = { 0, 0, 0 };   // trial points of this iteration
+        uint32_t trialCount = 0;
+
         mutable uint32_t evalCount = 0;
+        uint32_t iterationCount = 0;
         uint32_t vs = 0;         // index of vertex with smallest value
         uint32_t vh = 0;         // index of vertex with next smallest value
         uint32_t vg = 0;         // index of vertex with largest value 
@@ -90,17 +294,51 @@ class NelderMead
 
         // private methods
 
-        double doEvaluate(const std::vector<double>& x) const
+        void doInitialize(const std::vector<double>& start, double scale);
+        void doCopySimplex(const std::vector<std::vector<double>>& simplex);
+        void doBeginSearch(double tolerance, bool inTrackIds);
+        void doRun();
+        void doDirectRun();
+
+        // The thread pool is reached through these, which take the function as a
+        // plain pointer. This keeps the kernels that use forRange and forBlocks
+        // small enough to be inlined into the serial path.
+        template <typename Func>
+        static void callRange(const void * func, uint32_t begin, uint32_t end) { (*(const Func*)func)(begin, end); }
+        template <typename Func>
+        static void callBlock(const void * func, uint32_t block) { (*(const Func*)func)(block); }
+        NELDER_MEAD_NOINLINE void doParallelRange(uint32_t count, uint32_t chunkSize, void (*call)(const void*, uint32_t, uint32_t), const void * func) const;
+        NELDER_MEAD_NOINLINE void doParallelBlocks(uint32_t blocks, void (*call)(const void*, uint32_t), const void * func) const;
+        double doEvaluate(const std::vector<double>& x)
         {
+            double value = evalFunc(x);
             evalCount++;
-            return evalFunc(x);
+            instrumentation.evaluated(value);
+            return value;
         }
-
-        void doInitialize(const std::vector<double>& start, double scale);
-        void doIndexes();
+        void doIndexes() { Ordering::order(f, size, vs, vh, vg); }
+        void doTrialPoint(std::vector<double>& out, const std::vector<double>& toward, double coefficient);
+        void doAccept(const std::vector<double>& point, double value, uint64_t id);
+        void doShrink();
+        void doPendAll(bool fromStart);
+        uint64_t doPend(const std::vector<double>& point, uint64_t parent);
+        uint64_t doPendTrial(const std::vector<double>& point, uint64_t parent);
+        void doRetire(uint64_t id) { if (retireFunc) retireFunc(id); }
+        void doSettleTrials();
+        void doFinish();
+        void doBeginIteration();
+        void doContractionCheck();
+        void doEndIteration();
 
     #if NELDER_MEAD_DEBUG
         void doPrintStart();
         void doPrintIteration(uint32_t itr);
     #endif
 };
+
+using NelderMead = BasicNelderMead<NelderMeadDefaultPolicies>;
+
+// The default solver is compiled once, in nm.cpp
+extern template class BasicNelderMead<NelderMeadDefaultPolicies>;
+
+#include "nm_impl.h"
@@ -0,0 +1,186 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#include "nm_batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <unordered_map>
+
+
+NelderMeadBatch::NelderMeadBatch(uint32_t inThreadCount)
+    : pool(inThreadCount)
+{
+    solvers.resize(pool.getThreadCount());
+}
+
+NelderMeadBatch::~NelderMeadBatch()
+{
+}
+
+
+uint32_t NelderMeadBatch::add(const NelderMeadBatchProblem & problem)
+{
+    if (problem.size == 0) {
+        throw std::invalid_argument("NelderMeadBatch: a problem needs at least one variable");
+    }
+    if (problem.start.size() != problem.size) {
+        throw std::invalid_argument("NelderMeadBatch: the start point must have one value for each variable");
+    }
+    if (!problem.evalFunc) {
+        throw std::invalid_argument("NelderMeadBatch: a problem needs an evaluation function");
+    }
+    problems.push_back(problem);
+    return (uint32_t)problems.size() - 1;
+}
+
+void NelderMeadBatch::clear()
+{
+    problems.clear();
+    lastExecResults.clear();
+}
+
+void NelderMeadBatch::doBuildGroups(std::vector<std::vector<uint32_t>> & groups) const
+{
+    uint32_t count = (uint32_t)problems.size();
+
+    if (configOrder == NelderMeadBatchOrder::Arrival) {
+        groups.resize(count);
+        for (uint32_t i = 0; i < count; i++) {
+            groups[i].assign(1, i);
+        }
+        return;
+    }
+
+    // gather the problems by key, keeping the order they arrived in
+    std::unordered_map<uint64_t, uint32_t> groupOfKey;
+    for (uint32_t i = 0; i < count; i++) {
+        auto found = groupOfKey.emplace(problems[i].localityKey, (uint32_t)groups.size());
+        if (found.second) {
+            groups.emplace_back();
+        }
+        groups[found.first->second].push_back(i);
+    }
+
+    // A group larger than an even share of the batch would leave the other workers
+    // idle at the end, so it is split. Each part still runs back to back.
+    uint32_t threads = pool.getThreadCount();
+    uint32_t share = (count + threads - 1) / threads;
+    for (size_t g = 0, n = groups.size(); g < n; g++) {
+        while (groups[g].size() > share) {
+            std::vector<uint32_t> rest(groups[g].begin() + share, groups[g].end());
+            groups[g].resize(share);
+            groups.push_back(std::move(rest));
+        }
+    }
+
+    // largest groups first, so the smaller ones fill in the gaps at the end
+    std::stable_sort(groups.begin(), groups.end(),
+        [](const std::vector<uint32_t> & a, const std::vector<uint32_t> & b) { return a.size() > b.size(); });
+}
+
+NelderMead & NelderMeadBatch::doSolver(uint32_t chunk, uint32_t size, uint32_t slot)
+{
+    std::vector<std::unique_ptr<NelderMead>> & bySize = solvers[chunk][size];
+    while (bySize.size() <= slot) {
+        // points are evaluated by the batch through ask/tell, so the solver
+        // needs no evaluation function of its own
+        bySize.emplace_back(new NelderMead(size, nullptr, nullptr));
+    }
+    return *bySize[slot];
+}
+
+void NelderMeadBatch::doRunGroup(uint32_t chunk, const std::vector<uint32_t> & group)
+{
+    uint32_t width = configOrder == NelderMeadBatchOrder::Interleaved ? configInterleaveWidth : 1;
+    if (width > group.size()) {
+        width = (uint32_t)group.size();
+    }
+
+    // The problem running in each slot and the solver it is running on
+    std::vector<uint32_t> active(width);
+    std::vector<NelderMead*> slotSolver(width);
+    std::vector<double> values;
+    size_t next = 0;
+    uint32_t running = 0;
+
+    auto startNext = [&](uint32_t slot) {
+        if (next == group.size()) {
+            slotSolver[slot] = nullptr;
+            return;
+        }
+        const NelderMeadBatchProblem & problem = problems[group[next]];
+        active[slot] = group[next++];
+        slotSolver[slot] = &doSolver(chunk, problem.size, slot);
+        slotSolver[slot]->getConstraint().constrainFunc = problem.constrainFunc;
+        slotSolver[slot]->setMaxIterations(configMaxIterations);
+        slotSolver[slot]->start(problem.start, problem.tolerance, problem.scale);
+        running++;
+    };
+
+    for (uint32_t slot = 0; slot < width; slot++) {
+        startNext(slot);
+    }
+
+    // Step each running search in turn. With a width of one this simply runs the
+    // problems of the group one after the other.
+    while (running > 0) {
+        for (uint32_t slot = 0; slot < width; slot++) {
+            NelderMead * solver = slotSolver[slot];
+            if (!solver) {
+                continue;
+            }
+            const NelderMeadBatchProblem & problem = problems[active[slot]];
+            uint32_t count = solver->getPendingCount();
+            values.resize(count);
+            for (uint32_t i = 0; i < count; i++) {
+                values[i] = problem.evalFunc(solver->getPendingPoint(i));
+            }
+            solver->tell(values.data());
+
+            if (solver->isDone()) {
+                lastExecResults[active[slot]] = solver->getLastExecResults();
+                running--;
+                startNext(slot);
+            }
+        }
+    }
+}
+
+void NelderMeadBatch::exec()
+{
+    std::vector<std::vector<uint32_t>> groups;
+    doBuildGroups(groups);
+
+    lastExecResults.assign(problems.size(), NelderMeadResults());
+
+    // Every chunk claims whole groups until there are none left. An exception
+    // must not leave a pool chunk, so the first one is kept and every chunk
+    // stops claiming groups.
+    std::atomic<uint32_t> nextGroup{ 0 };
+    std::atomic<bool> failed{ false };
+    std::exception_ptr error;
+    pool.run(pool.getThreadCount(), [&](uint32_t chunk) {
+        try {
+            uint32_t g;
+            while (!failed.load() && (g = nextGroup.fetch_add(1)) < groups.size()) {
+                doRunGroup(chunk, groups[g]);
+            }
+        }
+        catch (...) {
+            if (!failed.exchange(true)) {
+                error = std::current_exception();
+            }
+        }
+    });
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
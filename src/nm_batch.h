@@ -0,0 +1,95 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#pragma once
+
+// system headers
+#include <stdint.h>
+
+// std library headers
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+// project headers
+#include "nm.h"
+
+
+// One search to be run as part of a batch. Problems with the same locality key
+// are expected to read the same data, for example the rows of one region.
+struct NelderMeadBatchProblem {
+    uint64_t localityKey = 0;
+    uint32_t size = 0;
+    std::function<double(const std::vector<double>&)> evalFunc;
+    std::function<void(std::vector<double>&)> constrainFunc;
+    std::vector<double> start;
+    double tolerance = 1.0e-6;
+    double scale = 1.0;
+};
+
+// How the problems of a batch are handed to the worker threads
+enum class NelderMeadBatchOrder {
+    Arrival,        // one at a time in the order they were added
+    Grouped,        // all problems with the same key run back to back on one worker
+    Interleaved     // as Grouped, but several problems of a group are stepped in turn
+};
+
+// Runs many independent searches across a set of worker threads. In the grouped
+// orders the problems sharing a locality key are kept together on one worker, so
+// the data they share stays in that worker's caches from one search to the next.
+class NelderMeadBatch
+{
+    public:
+        // Constructors and destructor
+
+        NelderMeadBatch(uint32_t inThreadCount);
+        ~NelderMeadBatch();
+
+        // public methods
+
+        // Adds a problem and returns its index in the results. Throws
+        // std::invalid_argument if the size is zero, the start point does not
+        // have size values or there is no evaluation function.
+        uint32_t add(const NelderMeadBatchProblem & problem);
+        void clear();
+
+        // Runs every problem. If an evaluation or constraint function throws,
+        // the workers stop taking new problems and the first exception is
+        // rethrown here once they have all stopped. The results of problems
+        // that did not complete are left empty.
+        void exec();
+        const std::vector<NelderMeadResults> & getLastExecResults() const { return lastExecResults; }
+
+        void setOrder(NelderMeadBatchOrder inValue) { configOrder = inValue; }
+        void setInterleaveWidth(uint32_t inValue) { configInterleaveWidth = inValue < 1 ? 1 : inValue; }
+        void setMaxIterations(uint32_t inValue) { configMaxIterations = inValue; }
+
+
+    private:
+        // Configuration values that can be modified by the user prior to an exec call
+
+        NelderMeadBatchOrder configOrder = NelderMeadBatchOrder::Grouped;
+        uint32_t configInterleaveWidth = 4;
+        uint32_t configMaxIterations = 1000;
+
+        NelderMeadThreadPool pool;
+        std::vector<NelderMeadBatchProblem> problems;
+
+        // Solvers are reused from one problem to the next. exec runs one pool chunk
+        // per thread, and each chunk keeps its own solvers, by problem size, as
+        // many as the interleave width.
+        std::vector<std::map<uint32_t, std::vector<std::unique_ptr<NelderMead>>>> solvers;
+
+        std::vector<NelderMeadResults> lastExecResults;
+
+        // private methods
+
+        void doBuildGroups(std::vector<std::vector<uint32_t>> & groups) const;
+        NelderMead & doSolver(uint32_t chunk, uint32_t size, uint32_t slot);
+        void doRunGroup(uint32_t chunk, const std::vector<uint32_t> & group);
+};
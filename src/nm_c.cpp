@@ -0,0 +1,286 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#include "nm_c.h"
+#include "nm.h"
+
+#include <new>
+
+
+// The handle behind the C interface. Everything a search needs is allocated
+// here when the handle is created, so searches themselves do not allocate.
+struct nm_solver {
+    nm_solver(uint32_t inSize)
+        : solver(inSize, nullptr, nullptr)
+    {
+        size = inSize;
+        start.resize(size);
+        points.resize(nm_points_capacity(size));
+        values.resize(nm_values_capacity(size));
+    }
+
+    uint32_t size = 0;
+    NelderMead solver;
+    std::vector<double> start;      // start point copied in from the caller
+    std::vector<double> points;     // pending points packed for nm_run
+    std::vector<double> values;     // their values, for nm_run
+
+    nm_constraint constrainFunc = nullptr;
+    void * constrainUser = nullptr;
+
+    uint32_t batchCount = 0;        // batches asked for by the current search
+    uint32_t lastBatchCount = 0;    // batches asked for by the last completed search
+};
+
+
+// Copies the pending points of a solver into one contiguous buffer
+static uint32_t packPending(const NelderMead & solver, uint32_t size, double * points)
+{
+    uint32_t count = solver.getPendingCount();
+    for (uint32_t i = 0; i < count; i++) {
+        const std::vector<double> & point = solver.getPendingPoint(i);
+        for (uint32_t j = 0; j < size; j++) {
+            points[i * size + j] = point[j];
+        }
+    }
+    return count;
+}
+
+static void startSearch(nm_solver * solver, const double * start, double tolerance, double scale)
+{
+    for (uint32_t j = 0; j < solver->size; j++) {
+        solver->start[j] = start[j];
+    }
+    solver->batchCount = 0;
+    solver->solver.start(solver->start, tolerance, scale);
+}
+
+static void tellSearch(nm_solver * solver, const double * values)
+{
+    solver->batchCount++;
+    solver->solver.tell(values);
+    if (solver->solver.isDone()) {
+        solver->lastBatchCount = solver->batchCount;
+    }
+}
+
+
+uint32_t nm_abi_version(void)
+{
+    return NM_ABI_VERSION;
+}
+
+size_t nm_points_capacity(uint32_t size)
+{
+    return ((size_t)size + 1) * size;
+}
+
+size_t nm_values_capacity(uint32_t size)
+{
+    return (size_t)size + 1;
+}
+
+nm_solver * nm_create(uint32_t size)
+{
+    if (size == 0) {
+        return nullptr;
+    }
+    try {
+        return new nm_solver(size);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void nm_destroy(nm_solver * solver)
+{
+    delete solver;
+}
+
+int nm_set_constraint(nm_solver * solver, nm_constraint func, void * user)
+{
+    if (!solver) {
+        return NM_ERROR_ARGUMENT;
+    }
+    solver->constrainFunc = func;
+    solver->constrainUser = user;
+    if (!func) {
+        solver->solver.getConstraint().constrainFunc = nullptr;
+        return NM_OK;
+    }
+    solver->solver.getConstraint().constrainFunc = [solver](std::vector<double> & x) {
+        solver->constrainFunc(solver->constrainUser, solver->size, x.data());
+    };
+    return NM_OK;
+}
+
+int nm_set_max_iterations(nm_solver * solver, uint32_t value)
+{
+    if (!solver) {
+        return NM_ERROR_ARGUMENT;
+    }
+    solver->solver.setMaxIterations(value);
+    return NM_OK;
+}
+
+int nm_set_reflection_coefficient(nm_solver * solver, double value)
+{
+    if (!solver) {
+        return NM_ERROR_ARGUMENT;
+    }
+    solver->solver.setReflectionCoefficient(value);
+    return NM_OK;
+}
+
+int nm_set_contraction_coefficient(nm_solver * solver, double value)
+{
+    if (!solver) {
+        return NM_ERROR_ARGUMENT;
+    }
+    solver->solver.setContractionCoefficient(value);
+    return NM_OK;
+}
+
+int nm_set_expansion_coefficient(nm_solver * solver, double value)
+{
+    if (!solver) {
+        return NM_ERROR_ARGUMENT;
+    }
+    solver->solver.setExpansionCoefficient(value);
+    return NM_OK;
+}
+
+int nm_set_strategy(nm_solver * solver, int strategy)
+{
+    if (!solver || strategy < NM_STRATEGY_GREEDY_MINIMIZATION || strategy > NM_STRATEGY_INSIDE_CONTRACTION_ONLY) {
+        return NM_ERROR_ARGUMENT;
+    }
+    solver->solver.setStrategy((NelderMeadStrategy)strategy);
+    return NM_OK;
+}
+
+int nm_set_expansion_growth(nm_solver * solver, double value)
+{
+    if (!solver) {
+        return NM_ERROR_ARGUMENT;
+    }
+    solver->solver.setExpansionGrowth(value);
+    return NM_OK;
+}
+
+int nm_set_thread_count(nm_solver * solver, uint32_t value)
+{
+    if (!solver) {
+        return NM_ERROR_ARGUMENT;
+    }
+    try {
+        solver->solver.setThreadCount(value);
+    }
+    catch (const std::bad_alloc &) {
+        return NM_ERROR_MEMORY;
+    }
+    catch (...) {
+        return NM_ERROR_INTERNAL;
+    }
+    return NM_OK;
+}
+
+int nm_run(nm_solver * solver, const double * start, double tolerance, double scale, nm_batch_objective func, void * user)
+{
+    if (!solver || !start || !func) {
+        return NM_ERROR_ARGUMENT;
+    }
+    try {
+        startSearch(solver, start, tolerance, scale);
+        while (!solver->solver.isDone()) {
+            uint32_t count = packPending(solver->solver, solver->size, solver->points.data());
+            func(user, count, solver->size, solver->points.data(), solver->values.data());
+            tellSearch(solver, solver->values.data());
+        }
+    }
+    catch (const std::bad_alloc &) {
+        return NM_ERROR_MEMORY;
+    }
+    catch (...) {
+        return NM_ERROR_INTERNAL;
+    }
+    return NM_OK;
+}
+
+int nm_start(nm_solver * solver, const double * start, double tolerance, double scale)
+{
+    if (!solver || !start) {
+        return NM_ERROR_ARGUMENT;
+    }
+    try {
+        startSearch(solver, start, tolerance, scale);
+    }
+    catch (const std::bad_alloc &) {
+        return NM_ERROR_MEMORY;
+    }
+    catch (...) {
+        return NM_ERROR_INTERNAL;
+    }
+    return NM_OK;
+}
+
+int nm_is_done(const nm_solver * solver)
+{
+    return !solver || solver->solver.isDone();
+}
+
+uint32_t nm_ask(nm_solver * solver, double * points)
+{
+    if (!solver || !points) {
+        return 0;
+    }
+    return packPending(solver->solver, solver->size, points);
+}
+
+int nm_tell(nm_solver * solver, const double * values)
+{
+    if (!solver || !values) {
+        return NM_ERROR_ARGUMENT;
+    }
+    if (solver->solver.isDone()) {
+        return NM_ERROR_STATE;
+    }
+    try {
+        tellSearch(solver, values);
+    }
+    catch (const std::bad_alloc &) {
+        return NM_ERROR_MEMORY;
+    }
+    catch (...) {
+        return NM_ERROR_INTERNAL;
+    }
+    return NM_OK;
+}
+
+int nm_get_results(const nm_solver * solver, nm_results * results, double * minValues)
+{
+    if (!solver || !results) {
+        return NM_ERROR_ARGUMENT;
+    }
+    const NelderMeadResults & last = solver->solver.getLastExecResults();
+    if (last.minValues.size() != solver->size) {
+        return NM_ERROR_STATE;
+    }
+
+    results->iterationCount = last.iterationCount;
+    results->evalCount = last.evalCount;
+    results->batchCount = solver->lastBatchCount;
+    results->reserved = 0;
+    results->min = last.min;
+    if (minValues) {
+        for (uint32_t j = 0; j < solver->size; j++) {
+            minValues[j] = last.minValues[j];
+        }
+    }
+    return NM_OK;
+}
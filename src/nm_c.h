@@ -0,0 +1,124 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+/*
+    C interface to the Nelder-Mead solver, meant for calling from other
+    languages through their foreign function interfaces. Only C types cross
+    this interface and the layout of everything declared here is stable;
+    new functions may be added but existing ones will not change.
+
+    Points always travel as one contiguous buffer of count * size doubles,
+    point after point, so a host language can evaluate a whole batch of
+    points with a single call across the boundary. There are two ways to
+    drive the solver:
+
+    1. nm_run, which calls a batch objective callback until the search is
+       complete. Every batch of pending points costs one callback.
+
+    2. nm_start, nm_ask and nm_tell, which let the caller evaluate the
+       points itself without any callback at all:
+
+           nm_start(solver, start, 1.0e-6, 1.0);
+           while (!nm_is_done(solver)) {
+               uint32_t count = nm_ask(solver, points);
+               ... evaluate count points into values ...
+               nm_tell(solver, values);
+           }
+
+    The points buffer given to nm_ask must hold nm_points_capacity(size)
+    doubles and the values buffer nm_values_capacity(size) doubles.
+
+    Batching only reduces the crossings while the initial simplex and a
+    shrunk simplex are evaluated. Within an iteration each trial point
+    depends on the value of the one before it, so a normal iteration still
+    costs one crossing for each of its one to three points, whichever way
+    the solver is driven.
+*/
+
+#pragma once
+
+/* system headers */
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NM_ABI_VERSION 1
+
+/* status codes returned by the functions below */
+#define NM_OK 0
+#define NM_ERROR_ARGUMENT 1     /* a null handle or buffer, or a size of zero */
+#define NM_ERROR_STATE 2        /* the call does not make sense at this point of the search */
+#define NM_ERROR_MEMORY 3       /* memory could not be allocated */
+#define NM_ERROR_INTERNAL 4     /* any other failure, such as a worker thread that could not be started */
+
+/* step strategies, see NelderMeadStrategy */
+#define NM_STRATEGY_GREEDY_MINIMIZATION 0
+#define NM_STRATEGY_GREEDY_EXPANSION 1
+#define NM_STRATEGY_REPEATED_EXPANSION 2
+#define NM_STRATEGY_INSIDE_CONTRACTION_ONLY 3
+
+typedef struct nm_solver nm_solver;
+
+/* Evaluates count points, each of size doubles, stored back to back in points
+   and writes one value per point to values. */
+typedef void (*nm_batch_objective)(void * user, uint32_t count, uint32_t size, const double * points, double * values);
+
+/* Moves a single point of size doubles into the feasible region, in place. */
+typedef void (*nm_constraint)(void * user, uint32_t size, double * point);
+
+/* Results of the last completed search. batchCount is the number of batches
+   of points the search asked for. nm_run calls the objective once per batch,
+   so this is the number of boundary crossings the search cost. */
+typedef struct nm_results {
+    uint32_t iterationCount;
+    uint32_t evalCount;
+    uint32_t batchCount;
+    uint32_t reserved;
+    double min;
+} nm_results;
+
+uint32_t nm_abi_version(void);
+
+/* Buffer sizes, in doubles, needed by nm_ask for a problem of size variables */
+size_t nm_points_capacity(uint32_t size);
+size_t nm_values_capacity(uint32_t size);
+
+/* Creation and destruction. nm_create returns null if size is zero. */
+nm_solver * nm_create(uint32_t size);
+void nm_destroy(nm_solver * solver);
+
+/* Configuration, used by the next search that is started. The exceptions
+   are the constraint, which is applied to every point from the next one on,
+   and the thread count, which only changes how the work is divided. */
+int nm_set_constraint(nm_solver * solver, nm_constraint func, void * user);
+int nm_set_max_iterations(nm_solver * solver, uint32_t value);
+int nm_set_reflection_coefficient(nm_solver * solver, double value);
+int nm_set_contraction_coefficient(nm_solver * solver, double value);
+int nm_set_expansion_coefficient(nm_solver * solver, double value);
+int nm_set_strategy(nm_solver * solver, int strategy);
+int nm_set_expansion_growth(nm_solver * solver, double value);
+int nm_set_thread_count(nm_solver * solver, uint32_t value);
+
+/* Runs a complete search, calling func for every batch of pending points */
+int nm_run(nm_solver * solver, const double * start, double tolerance, double scale, nm_batch_objective func, void * user);
+
+/* Ask/tell interface */
+int nm_start(nm_solver * solver, const double * start, double tolerance, double scale);
+int nm_is_done(const nm_solver * solver);
+uint32_t nm_ask(nm_solver * solver, double * points);
+int nm_tell(nm_solver * solver, const double * values);
+
+/* Results of the last completed search. minValues, if not null, receives the
+   size coordinates of the best point found. */
+int nm_get_results(const nm_solver * solver, nm_results * results, double * minValues);
+
+#ifdef __cplusplus
+}
+#endif
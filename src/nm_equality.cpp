@@ -0,0 +1,279 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#include "nm_equality.h"
+
+#include <math.h>
+
+#include <stdexcept>
+
+
+// Rows of A whose remaining norm, after removing the directions of the rows
+// chosen before them, is below this fraction of their original norm are
+// treated as dependent on those rows.
+static const double dependentRow = 1.0e-10;
+
+// A dependent row is consistent with the others when its value differs from
+// theirs by at most this fraction of the size of the row's terms
+static const double consistentRow = 1.0e-8;
+
+
+NelderMeadEquality::NelderMeadEquality(
+    uint32_t inSize,
+    const std::vector<std::vector<double>> & inA,
+    const std::vector<double> & inB,
+    const std::function<double(const std::vector<double>&)> & inEvalFunc,
+    const std::function<void(std::vector<double>&)> & inConstrainFunc
+)
+{
+    if (inB.size() != inA.size()) {
+        throw std::invalid_argument("NelderMeadEquality: b must have one value for each row of A");
+    }
+    for (auto & row : inA) {
+        if (row.size() < inSize) {
+            throw std::invalid_argument("NelderMeadEquality: every row of A needs a value for each variable");
+        }
+    }
+
+    size = inSize;
+    evalFunc = inEvalFunc;
+    constrainFunc = inConstrainFunc;
+    x.resize(size);
+    constrained.resize(size);
+
+    doFactor(inA, inB);
+
+    y.resize(reducedSize);
+    if (reducedSize > 0) {
+        solver.reset(new NelderMead(reducedSize, [this](const std::vector<double> & reduced) {
+            doExpand(reduced, x);
+            return evalFunc(x);
+        }, nullptr));
+        if (constrainFunc) {
+            solver->getConstraint().constrainFunc = [this](std::vector<double> & reduced) {
+                doExpand(reduced, constrained);
+                constrainFunc(constrained);
+                doReduce(constrained, reduced);
+            };
+        }
+    }
+}
+
+NelderMeadEquality::~NelderMeadEquality()
+{
+}
+
+
+void NelderMeadEquality::doFactor(const std::vector<std::vector<double>> & a, const std::vector<double> & b)
+{
+    // Householder QR of A^T, whose columns are the rows of A, with column
+    // pivoting so that dependent rows are left until last and then recognized.
+    // With r independent rows A^T P = Q R, where R is r by r upper triangular:
+    //
+    //     x0 = Q1 w, where R^T w = P^T b, is the smallest solution of A x = b
+    //     Z = Q2, the last size - r columns of Q, spans the null space of A
+    //
+    // Both are formed by applying the r reflections to a vector, so the whole
+    // factorization is O(size^2 m).
+    uint32_t m = (uint32_t)a.size();
+    std::vector<std::vector<double>> col(m);
+    std::vector<double> original(m);
+    std::vector<bool> dependent(m, false);
+    std::vector<bool> chosen(m, false);
+    std::vector<uint32_t> order;     // independent rows, in the order they were chosen
+    std::vector<std::vector<double>> reflection;
+
+    for (uint32_t i = 0; i < m; i++) {
+        col[i].assign(a[i].begin(), a[i].begin() + size);
+        double norm = 0.0;
+        for (double c : col[i]) {
+            norm += c * c;
+        }
+        original[i] = sqrt(norm);
+        dependent[i] = original[i] == 0.0;
+    }
+
+    for (uint32_t k = 0; k < size && order.size() < m; k++) {
+        // pivot on the row with the most left over, once rows with too little
+        // left have been set aside as dependent
+        uint32_t pivot = m;
+        double pivotNorm = 0.0;
+        for (uint32_t i = 0; i < m; i++) {
+            if (dependent[i] || chosen[i]) {
+                continue;
+            }
+            double norm = 0.0;
+            for (uint32_t j = k; j < size; j++) {
+                norm += col[i][j] * col[i][j];
+            }
+            norm = sqrt(norm);
+            if (norm <= dependentRow * original[i]) {
+                dependent[i] = true;
+                continue;
+            }
+            if (norm > pivotNorm) {
+                pivot = i;
+                pivotNorm = norm;
+            }
+        }
+        if (pivot == m) {
+            break;
+        }
+        order.push_back(pivot);
+        chosen[pivot] = true;
+
+        // the reflection that takes the rest of the pivot column onto e_k
+        std::vector<double> v(col[pivot].begin() + k, col[pivot].end());
+        double alpha = v[0] > 0.0 ? -pivotNorm : pivotNorm;
+        v[0] -= alpha;
+        double vNorm = 0.0;
+        for (double c : v) {
+            vNorm += c * c;
+        }
+        vNorm = sqrt(vNorm);
+        for (auto & c : v) {
+            c /= vNorm;
+        }
+
+        for (uint32_t i = 0; i < m; i++) {
+            if (!chosen[i] || i == pivot) {
+                doReflect(v, k, col[i]);
+            }
+        }
+        reflection.push_back(v);
+    }
+
+    // Any row not chosen depends on the chosen ones
+    uint32_t rank = (uint32_t)order.size();
+
+    // R^T w = P^T b by forward substitution; R(i, j) is col[order[j]][i]
+    std::vector<double> w(size, 0.0);
+    for (uint32_t j = 0; j < rank; j++) {
+        const std::vector<double> & r = col[order[j]];
+        double sum = b[order[j]];
+        for (uint32_t i = 0; i < j; i++) {
+            sum -= r[i] * w[i];
+        }
+        w[j] = sum / r[j];
+    }
+
+    // A dependent row is a combination of the chosen ones, so its right hand
+    // side must be the same combination of theirs. The row times x0 is off by
+    // rounding in proportion to |a_i| |x0|, and |x0| = |w|, so the tolerance
+    // scales with both sides and does not change when a row and its value are
+    // scaled together.
+    double wNorm = 0.0;
+    for (uint32_t j = 0; j < rank; j++) {
+        wNorm += w[j] * w[j];
+    }
+    wNorm = sqrt(wNorm);
+    for (uint32_t i = 0; i < m; i++) {
+        if (chosen[i]) {
+            continue;
+        }
+        double sum = 0.0;
+        for (uint32_t j = 0; j < rank; j++) {
+            sum += col[i][j] * w[j];
+        }
+        if (fabs(b[i] - sum) > consistentRow * (fabs(b[i]) + original[i] * wNorm)) {
+            consistent = false;
+        }
+    }
+
+    // x0 = Q (w, 0) and column c of Z = Q e_(rank + c), applying the
+    // reflections in reverse
+    x0 = w;
+    for (uint32_t k = rank; k-- > 0;) {
+        doReflect(reflection[k], k, x0);
+    }
+
+    reducedSize = size - rank;
+    z.assign((size_t)size * reducedSize, 0.0);
+    std::vector<double> e(size);
+    for (uint32_t c = 0; c < reducedSize; c++) {
+        e.assign(size, 0.0);
+        e[rank + c] = 1.0;
+        for (uint32_t k = rank; k-- > 0;) {
+            doReflect(reflection[k], k, e);
+        }
+        for (uint32_t j = 0; j < size; j++) {
+            z[(size_t)j * reducedSize + c] = e[j];
+        }
+    }
+}
+
+void NelderMeadEquality::doReflect(const std::vector<double> & v, uint32_t k, std::vector<double> & u)
+{
+    // u = (I - 2 v v^T) u, with v acting on the elements from k on
+    double d = 0.0;
+    for (size_t j = 0; j < v.size(); j++) {
+        d += v[j] * u[k + j];
+    }
+    d *= 2.0;
+    for (size_t j = 0; j < v.size(); j++) {
+        u[k + j] -= d * v[j];
+    }
+}
+
+void NelderMeadEquality::doExpand(const std::vector<double> & reduced, std::vector<double> & full) const
+{
+    // x = x0 + Z y in one pass over Z
+    const double * row = z.data();
+    for (uint32_t j = 0; j < size; j++, row += reducedSize) {
+        double sum = x0[j];
+        for (uint32_t k = 0; k < reducedSize; k++) {
+            sum += row[k] * reduced[k];
+        }
+        full[j] = sum;
+    }
+}
+
+void NelderMeadEquality::exec(const std::vector<double> & inStart, double tolerance, double scale)
+{
+    if (!consistent) {
+        throw std::invalid_argument("NelderMeadEquality: the equalities contradict each other");
+    }
+    if (inStart.size() != size) {
+        throw std::invalid_argument("NelderMeadEquality: the start point must have one value for each variable");
+    }
+
+    // With no freedom left there is only one point to evaluate
+    if (reducedSize == 0) {
+        lastExecResults.iterationCount = 0;
+        lastExecResults.evalCount = 1;
+        lastExecResults.minValues = x0;
+        lastExecResults.min = evalFunc(x0);
+        return;
+    }
+
+    // x0 + Z y is the projection of the start point
+    doReduce(inStart, y);
+
+    solver->exec(y, tolerance, scale);
+
+    const NelderMeadResults & reduced = solver->getLastExecResults();
+    lastExecResults.iterationCount = reduced.iterationCount;
+    lastExecResults.evalCount = reduced.evalCount;
+    lastExecResults.min = reduced.min;
+    lastExecResults.minValues.resize(size);
+    doExpand(reduced.minValues, lastExecResults.minValues);
+}
+
+void NelderMeadEquality::doReduce(const std::vector<double> & full, std::vector<double> & reduced) const
+{
+    // y = Z^T (x - x0), the coordinates of the projection of x
+    for (uint32_t k = 0; k < reducedSize; k++) {
+        reduced[k] = 0.0;
+    }
+    const double * row = z.data();
+    for (uint32_t j = 0; j < size; j++, row += reducedSize) {
+        double d = full[j] - x0[j];
+        for (uint32_t k = 0; k < reducedSize; k++) {
+            reduced[k] += row[k] * d;
+        }
+    }
+}
@@ -0,0 +1,96 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#pragma once
+
+// system headers
+#include <stdint.h>
+
+// std library headers
+#include <functional>
+#include <memory>
+#include <vector>
+
+// project headers
+#include "nm.h"
+
+
+// Minimizes a function of size variables subject to the linear equalities
+// A x = b. Rather than spending simplex dimensions on directions that can never
+// be feasible, the search runs over the coordinates y of the null space of A:
+//
+//     x = x0 + Z y
+//
+// where x0 is the smallest solution of A x = b and the columns of Z are an
+// orthonormal basis of the null space. With m independent equalities the
+// simplex has size - m dimensions. Every point handed to the evaluation function
+// and every result is in the original coordinates, and satisfies the equalities
+// to rounding.
+//
+// The constraint function, if given, works in the original coordinates too. The
+// point it returns is projected back onto the equalities. A constraint that keeps
+// to the equalities is met exactly; one that moves points off them is only met
+// as closely as the projection allows.
+//
+// The constructor throws std::invalid_argument unless b has one value for each
+// row of A and every row has at least size values. Equalities that contradict
+// each other have no feasible point; isConsistent() reports them after
+// construction and exec throws std::invalid_argument for them.
+class NelderMeadEquality
+{
+    public:
+        // Constructors and destructor
+
+        NelderMeadEquality(
+            uint32_t inSize,
+            const std::vector<std::vector<double>> & inA,
+            const std::vector<double> & inB,
+            const std::function<double(const std::vector<double>&)> &,
+            const std::function<void(std::vector<double>&)> & = nullptr
+        );
+        ~NelderMeadEquality();
+
+        // public methods
+
+        // The start point is projected onto the feasible set before the search.
+        // Throws std::invalid_argument if the equalities are not consistent or
+        // the start point does not have size values.
+        void exec(const std::vector<double> & inStart, double tolerance, double scale);
+        const NelderMeadResults & getLastExecResults() const { return lastExecResults; }
+
+        uint32_t getReducedSize() const { return reducedSize; }
+
+        // False if some equalities contradict the others
+        bool isConsistent() const { return consistent; }
+
+        // The solver for the reduced problem, for changing its settings
+        NelderMead & getSolver() { return *solver; }
+
+
+    private:
+        uint32_t size = 0;
+        uint32_t reducedSize = 0;
+        bool consistent = true;
+        std::function<double(const std::vector<double>&)> evalFunc;
+        std::function<void(std::vector<double>&)> constrainFunc;
+
+        std::vector<double> x0;     // particular solution
+        std::vector<double> z;      // null space basis, size rows of reducedSize, row major
+        std::vector<double> x;      // full coordinates of the point being evaluated
+        std::vector<double> constrained;    // and of the point being constrained
+        std::vector<double> y;      // reduced coordinates of the start point
+
+        std::unique_ptr<NelderMead> solver;
+        NelderMeadResults lastExecResults;
+
+        // private methods
+
+        void doFactor(const std::vector<std::vector<double>> & a, const std::vector<double> & b);
+        void doExpand(const std::vector<double> & reduced, std::vector<double> & full) const;
+        void doReduce(const std::vector<double> & full, std::vector<double> & reduced) const;
+        static void doReflect(const std::vector<double> & v, uint32_t k, std::vector<double> & u);
+};
@@ -0,0 +1,606 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#include "nm_farm.h"
+
+#include <string.h>
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#define NM_INVALID_SOCKET INVALID_SOCKET
+#define NM_SEND_FLAGS 0
+#define nmPoll WSAPoll
+typedef WSAPOLLFD NelderMeadPollFd;
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define NM_INVALID_SOCKET (-1)
+#ifdef MSG_NOSIGNAL
+#define NM_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define NM_SEND_FLAGS 0
+#endif
+#define nmPoll poll
+typedef struct pollfd NelderMeadPollFd;
+#endif
+
+
+// Size of the fixed header at the start of every frame, and the magic and
+// version it starts with
+static const size_t headerSize = 24;
+static const uint32_t frameMagic = 0x4D464D4E;
+static const uint32_t frameVersion = 1;
+
+// How often blocking loops wake up to check whether they have been stopped
+static const int pollInterval = 50;
+
+
+#ifdef _WIN32
+// Winsock has to be started once per process before any socket is used
+static struct NelderMeadWinsock {
+    NelderMeadWinsock() { WSADATA data; WSAStartup(MAKEWORD(2, 2), &data); }
+    ~NelderMeadWinsock() { WSACleanup(); }
+} winsock;
+#endif
+
+static void closeSocket(NelderMeadSocket s)
+{
+#ifdef _WIN32
+    closesocket((SOCKET)s);
+#else
+    close(s);
+#endif
+}
+
+static bool sendAll(NelderMeadSocket s, const char * data, size_t length)
+{
+    while (length > 0) {
+        int sent = (int)send(s, data, (int)length, NM_SEND_FLAGS);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+static void setNoDelay(NelderMeadSocket s)
+{
+    int on = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+}
+
+static void putHeader(std::vector<char> & out, NelderMeadFarmFrame type, uint32_t count, uint64_t id)
+{
+    uint32_t t = (uint32_t)type;
+    out.resize(headerSize + count * sizeof(double));
+    memcpy(&out[0], &frameMagic, 4);
+    memcpy(&out[4], &frameVersion, 4);
+    memcpy(&out[8], &t, 4);
+    memcpy(&out[12], &count, 4);
+    memcpy(&out[16], &id, 8);
+}
+
+// Results of takeFrame
+enum class FrameStatus {
+    Taken,
+    Incomplete,
+    Invalid
+};
+
+// Removes the first complete frame from input. A header is checked as soon as
+// it arrives, so the payload of a frame that is not valid is never waited for.
+// Evaluate frames may hold up to maxPointSize doubles.
+static FrameStatus takeFrame(std::vector<char> & input, NelderMeadFarmFrame & type, uint64_t & id, std::vector<double> & payload, uint32_t maxPointSize)
+{
+    if (input.size() < headerSize) {
+        return FrameStatus::Incomplete;
+    }
+    uint32_t magic, version, t, count;
+    memcpy(&magic, &input[0], 4);
+    memcpy(&version, &input[4], 4);
+    memcpy(&t, &input[8], 4);
+    memcpy(&count, &input[12], 4);
+    memcpy(&id, &input[16], 8);
+    if (magic != frameMagic || version != frameVersion) {
+        return FrameStatus::Invalid;
+    }
+    switch ((NelderMeadFarmFrame)t) {
+        case NelderMeadFarmFrame::Evaluate:
+            if (count > maxPointSize) {
+                return FrameStatus::Invalid;
+            }
+            break;
+        case NelderMeadFarmFrame::Result:
+            if (count != 1) {
+                return FrameStatus::Invalid;
+            }
+            break;
+        case NelderMeadFarmFrame::Heartbeat:
+        case NelderMeadFarmFrame::Shutdown:
+            if (count != 0) {
+                return FrameStatus::Invalid;
+            }
+            break;
+        default:
+            return FrameStatus::Invalid;
+    }
+
+    size_t length = headerSize + (size_t)count * sizeof(double);
+    if (input.size() < length) {
+        return FrameStatus::Incomplete;
+    }
+
+    type = (NelderMeadFarmFrame)t;
+    payload.resize(count);
+    if (count > 0) {
+        memcpy(payload.data(), &input[headerSize], count * sizeof(double));
+    }
+    input.erase(input.begin(), input.begin() + length);
+    return FrameStatus::Taken;
+}
+
+// Reads whatever is available on a readable socket. Returns false once the
+// connection is closed or broken.
+static bool receiveSome(NelderMeadSocket s, std::vector<char> & input)
+{
+    char buffer[65536];
+    int received = (int)recv(s, buffer, sizeof(buffer), 0);
+    if (received <= 0) {
+        return false;
+    }
+    input.insert(input.end(), buffer, buffer + received);
+    return true;
+}
+
+// Splits "tcp:host:port" or "unix:path"
+static bool parseEndpoint(const std::string & endpoint, bool & isUnix, std::string & host, std::string & port)
+{
+    if (endpoint.compare(0, 5, "unix:") == 0) {
+        isUnix = true;
+        host = endpoint.substr(5);
+        return !host.empty();
+    }
+    if (endpoint.compare(0, 4, "tcp:") == 0) {
+        size_t colon = endpoint.rfind(':');
+        if (colon <= 4) {
+            return false;
+        }
+        isUnix = false;
+        host = endpoint.substr(4, colon - 4);
+        port = endpoint.substr(colon + 1);
+        return true;
+    }
+    return false;
+}
+
+static NelderMeadSocket openSocket(const std::string & endpoint, bool toListen, std::string * bound)
+{
+    bool isUnix;
+    std::string host, port;
+    if (!parseEndpoint(endpoint, isUnix, host, port)) {
+        return NM_INVALID_SOCKET;
+    }
+
+    if (isUnix) {
+#ifdef _WIN32
+        return NM_INVALID_SOCKET;
+#else
+        sockaddr_un address;
+        if (host.size() >= sizeof(address.sun_path)) {
+            return NM_INVALID_SOCKET;
+        }
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strcpy(address.sun_path, host.c_str());
+
+        NelderMeadSocket s = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (s == NM_INVALID_SOCKET) {
+            return s;
+        }
+        if (toListen) {
+            unlink(host.c_str());
+        }
+        bool ok = toListen
+            ? bind(s, (sockaddr*)&address, sizeof(address)) == 0 && ::listen(s, 16) == 0
+            : ::connect(s, (sockaddr*)&address, sizeof(address)) == 0;
+        if (!ok) {
+            closeSocket(s);
+            return NM_INVALID_SOCKET;
+        }
+        if (bound) {
+            *bound = endpoint;
+        }
+        return s;
+#endif
+    }
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = toListen ? AI_PASSIVE : 0;
+    addrinfo * found = nullptr;
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &found) != 0) {
+        return NM_INVALID_SOCKET;
+    }
+
+    NelderMeadSocket s = NM_INVALID_SOCKET;
+    for (addrinfo * a = found; a && s == NM_INVALID_SOCKET; a = a->ai_next) {
+        s = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (s == NM_INVALID_SOCKET) {
+            continue;
+        }
+        bool ok;
+        if (toListen) {
+            int on = 1;
+            setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char*)&on, sizeof(on));
+            ok = bind(s, a->ai_addr, (int)a->ai_addrlen) == 0 && ::listen(s, 16) == 0;
+        }
+        else {
+            ok = ::connect(s, a->ai_addr, (int)a->ai_addrlen) == 0;
+        }
+        if (!ok) {
+            closeSocket(s);
+            s = NM_INVALID_SOCKET;
+        }
+    }
+    freeaddrinfo(found);
+
+    if (s != NM_INVALID_SOCKET) {
+        setNoDelay(s);
+        if (bound) {
+            sockaddr_storage address;
+            socklen_t length = sizeof(address);
+            char service[16];
+            getsockname(s, (sockaddr*)&address, &length);
+            getnameinfo((sockaddr*)&address, length, nullptr, 0, service, sizeof(service), NI_NUMERICSERV);
+            *bound = "tcp:" + host + ":" + service;
+        }
+    }
+    return s;
+}
+
+
+NelderMeadFarmWorker::NelderMeadFarmWorker(const std::function<double(const std::vector<double>&)> & inEvalFunc)
+{
+    evalFunc = inEvalFunc;
+    listener = NM_INVALID_SOCKET;
+}
+
+NelderMeadFarmWorker::~NelderMeadFarmWorker()
+{
+    stop();
+    if (listener != NM_INVALID_SOCKET) {
+        closeSocket(listener);
+    }
+#ifndef _WIN32
+    if (!unixPath.empty()) {
+        unlink(unixPath.c_str());
+    }
+#endif
+}
+
+
+bool NelderMeadFarmWorker::listen(const std::string & endpoint)
+{
+    if (listener != NM_INVALID_SOCKET) {
+        closeSocket(listener);
+    }
+    listener = openSocket(endpoint, true, &boundEndpoint);
+    if (listener != NM_INVALID_SOCKET && endpoint.compare(0, 5, "unix:") == 0) {
+        unixPath = endpoint.substr(5);
+    }
+    return listener != NM_INVALID_SOCKET;
+}
+
+void NelderMeadFarmWorker::start()
+{
+    stopping = false;
+    serveThread = std::thread([this]() { serve(); });
+}
+
+void NelderMeadFarmWorker::stop()
+{
+    stopping = true;
+    if (serveThread.joinable()) {
+        serveThread.join();
+    }
+}
+
+void NelderMeadFarmWorker::serve()
+{
+    while (!stopping && listener != NM_INVALID_SOCKET) {
+        NelderMeadPollFd p;
+        p.fd = listener;
+        p.events = POLLIN;
+        p.revents = 0;
+        if (nmPoll(&p, 1, pollInterval) <= 0) {
+            continue;
+        }
+
+        NelderMeadSocket connection = accept(listener, nullptr, nullptr);
+        if (connection == NM_INVALID_SOCKET) {
+            continue;
+        }
+        if (unixPath.empty()) {
+            setNoDelay(connection);
+        }
+        bool shutdown = doServeConnection(connection);
+        closeSocket(connection);
+        if (shutdown) {
+            break;
+        }
+    }
+}
+
+bool NelderMeadFarmWorker::doServeConnection(NelderMeadSocket connection)
+{
+    std::mutex sendLock;
+    std::atomic<bool> connected{ true };
+
+    // Heartbeats come from their own thread so that they keep going while a
+    // long evaluation is running.
+    std::thread heartbeat([&]() {
+        std::vector<char> beat;
+        putHeader(beat, NelderMeadFarmFrame::Heartbeat, 0, 0);
+        auto next = std::chrono::steady_clock::now();
+        while (connected && !stopping) {
+            if (std::chrono::steady_clock::now() >= next) {
+                std::lock_guard<std::mutex> guard(sendLock);
+                if (!sendAll(connection, beat.data(), beat.size())) {
+                    break;
+                }
+                next += std::chrono::milliseconds(configHeartbeatInterval);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(configHeartbeatInterval < pollInterval ? configHeartbeatInterval : pollInterval));
+        }
+    });
+
+    std::vector<char> input;
+    std::vector<char> output;
+    std::vector<double> point;
+    bool shutdown = false;
+
+    while (!stopping && !shutdown) {
+        NelderMeadPollFd p;
+        p.fd = connection;
+        p.events = POLLIN;
+        p.revents = 0;
+        if (nmPoll(&p, 1, pollInterval) <= 0) {
+            continue;
+        }
+        if (!receiveSome(connection, input)) {
+            break;
+        }
+
+        NelderMeadFarmFrame type;
+        uint64_t id;
+        FrameStatus status;
+        bool broken = false;
+        while (!broken && !stopping &&
+            (status = takeFrame(input, type, id, point, configMaxPointSize)) != FrameStatus::Incomplete) {
+            if (status == FrameStatus::Invalid) {
+                broken = true;
+                break;
+            }
+            if (type == NelderMeadFarmFrame::Shutdown) {
+                shutdown = true;
+                break;
+            }
+            if (type != NelderMeadFarmFrame::Evaluate) {
+                continue;
+            }
+            double value = evalFunc(point);
+            putHeader(output, NelderMeadFarmFrame::Result, 1, id);
+            memcpy(&output[headerSize], &value, sizeof(double));
+            std::lock_guard<std::mutex> guard(sendLock);
+            broken = !sendAll(connection, output.data(), output.size());
+        }
+        if (broken) {
+            break;
+        }
+    }
+
+    connected = false;
+    heartbeat.join();
+    return shutdown;
+}
+
+
+NelderMeadEvalFarm::NelderMeadEvalFarm(const std::vector<std::string> & inEndpoints)
+{
+    workers.resize(inEndpoints.size());
+    for (size_t i = 0; i < inEndpoints.size(); i++) {
+        workers[i].endpoint = inEndpoints[i];
+        workers[i].socket = NM_INVALID_SOCKET;
+    }
+    connect();
+}
+
+NelderMeadEvalFarm::~NelderMeadEvalFarm()
+{
+    for (auto & worker : workers) {
+        if (worker.connected) {
+            closeSocket(worker.socket);
+        }
+    }
+}
+
+
+uint32_t NelderMeadEvalFarm::connect()
+{
+    for (auto & worker : workers) {
+        if (!worker.connected) {
+            worker.socket = openSocket(worker.endpoint, false, nullptr);
+            worker.connected = worker.socket != NM_INVALID_SOCKET;
+            worker.outstanding.clear();
+            worker.input.clear();
+        }
+    }
+    return getWorkerCount();
+}
+
+uint32_t NelderMeadEvalFarm::getWorkerCount() const
+{
+    uint32_t count = 0;
+    for (auto & worker : workers) {
+        count += worker.connected ? 1 : 0;
+    }
+    return count;
+}
+
+void NelderMeadEvalFarm::shutdown()
+{
+    putHeader(frame, NelderMeadFarmFrame::Shutdown, 0, 0);
+    for (auto & worker : workers) {
+        if (worker.connected) {
+            sendAll(worker.socket, frame.data(), frame.size());
+            closeSocket(worker.socket);
+            worker.connected = false;
+        }
+    }
+}
+
+void NelderMeadEvalFarm::doDrop(Worker & worker, std::vector<uint32_t> & queue, uint64_t firstId)
+{
+    closeSocket(worker.socket);
+    worker.connected = false;
+    for (uint64_t id : worker.outstanding) {
+        queue.push_back((uint32_t)(id - firstId));
+    }
+    worker.outstanding.clear();
+    worker.input.clear();
+}
+
+double NelderMeadEvalFarm::evaluate(const std::vector<double> & point)
+{
+    const std::vector<double> * points[1] = { &point };
+    double value;
+    evaluate(1, points, &value);
+    return value;
+}
+
+void NelderMeadEvalFarm::evaluate(uint32_t count, const std::vector<double>* const* points, double * values)
+{
+    uint64_t firstId = nextId;
+    nextId += count;
+
+    // points still to be sent, taken from the back
+    std::vector<uint32_t> queue(count);
+    for (uint32_t i = 0; i < count; i++) {
+        queue[i] = count - 1 - i;
+    }
+    std::vector<bool> done(count, false);
+    uint32_t remaining = count;
+
+    std::vector<NelderMeadPollFd> polls;
+    std::vector<Worker*> polled;
+    std::vector<double> payload;
+
+    while (remaining > 0) {
+        // hand out work to the least loaded workers that have room for more
+        while (!queue.empty()) {
+            Worker * target = nullptr;
+            for (auto & worker : workers) {
+                if (worker.connected && worker.outstanding.size() < configPipelineDepth &&
+                    (!target || worker.outstanding.size() < target->outstanding.size())) {
+                    target = &worker;
+                }
+            }
+            if (!target) {
+                break;
+            }
+
+            uint32_t index = queue.back();
+            queue.pop_back();
+            const std::vector<double> & point = *points[index];
+            putHeader(frame, NelderMeadFarmFrame::Evaluate, (uint32_t)point.size(), firstId + index);
+            if (!point.empty()) {
+                memcpy(&frame[headerSize], point.data(), point.size() * sizeof(double));
+            }
+
+            if (target->outstanding.empty()) {
+                target->lastHeard = std::chrono::steady_clock::now();
+            }
+            target->outstanding.push_back(firstId + index);
+            if (!sendAll(target->socket, frame.data(), frame.size())) {
+                doDrop(*target, queue, firstId);
+            }
+        }
+
+        polls.clear();
+        polled.clear();
+        for (auto & worker : workers) {
+            if (worker.connected) {
+                NelderMeadPollFd p;
+                p.fd = worker.socket;
+                p.events = POLLIN;
+                p.revents = 0;
+                polls.push_back(p);
+                polled.push_back(&worker);
+            }
+        }
+        if (polls.empty()) {
+            throw std::runtime_error("NelderMeadEvalFarm: no workers left");
+        }
+
+        nmPoll(polls.data(), (unsigned long)polls.size(), pollInterval);
+
+        auto now = std::chrono::steady_clock::now();
+        for (size_t p = 0; p < polls.size(); p++) {
+            Worker & worker = *polled[p];
+            if (polls[p].revents != 0) {
+                if (!receiveSome(worker.socket, worker.input)) {
+                    doDrop(worker, queue, firstId);
+                    continue;
+                }
+                worker.lastHeard = now;
+
+                NelderMeadFarmFrame type;
+                uint64_t id;
+                FrameStatus status;
+                while ((status = takeFrame(worker.input, type, id, payload, 0)) == FrameStatus::Taken) {
+                    if (type != NelderMeadFarmFrame::Result) {
+                        continue;
+                    }
+                    for (size_t k = 0; k < worker.outstanding.size(); k++) {
+                        if (worker.outstanding[k] == id) {
+                            worker.outstanding.erase(worker.outstanding.begin() + k);
+                            break;
+                        }
+                    }
+                    // results from earlier calls, or for points already answered, are ignored
+                    if (id >= firstId && id < firstId + count && !done[id - firstId]) {
+                        values[id - firstId] = payload[0];
+                        done[id - firstId] = true;
+                        remaining--;
+                    }
+                }
+                if (status == FrameStatus::Invalid) {
+                    doDrop(worker, queue, firstId);
+                    continue;
+                }
+            }
+
+            if (!worker.outstanding.empty() &&
+                now - worker.lastHeard > std::chrono::milliseconds(configHeartbeatTimeout)) {
+                doDrop(worker, queue, firstId);
+            }
+        }
+    }
+}
@@ -0,0 +1,167 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#pragma once
+
+// system headers
+#include <stdint.h>
+
+// std library headers
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// An evaluation farm sends points to worker processes over sockets and collects
+// their values. Endpoints are written as "tcp:host:port" or, except on Windows,
+// "unix:path".
+//
+// Every message is a frame of a fixed 24 byte header followed by count doubles,
+// all in the byte order of the machines involved (the farm assumes they match):
+//
+//     uint32_t magic;     // 0x4D464D4E, "NMFM" in little endian byte order
+//     uint32_t version;   // 1
+//     uint32_t type;      // one of NelderMeadFarmFrame
+//     uint32_t count;     // number of doubles that follow
+//     uint64_t id;        // evaluation id, echoed back in the result
+//
+// The coordinator sends Evaluate frames holding a point, the worker answers with
+// a Result frame holding its value. Workers send Heartbeat frames on a timer,
+// even while busy, so the coordinator can tell a slow worker from a lost one.
+// A Result frame holds exactly one double, Heartbeat and Shutdown frames none.
+// A frame with another magic, version, type or count ends the connection as
+// soon as its header arrives.
+enum class NelderMeadFarmFrame : uint32_t {
+    Evaluate = 1,
+    Result = 2,
+    Heartbeat = 3,
+    Shutdown = 4
+};
+
+#ifdef _WIN32
+typedef uintptr_t NelderMeadSocket;
+#else
+typedef int NelderMeadSocket;
+#endif
+
+
+// The worker side of a farm. A worker process constructs one with its evaluation
+// function, listens on an endpoint and serves coordinators until shut down. It
+// can also run on a background thread in the calling process, which makes it a
+// local stand-in for a remote worker.
+class NelderMeadFarmWorker
+{
+    public:
+        // Constructors and destructor
+
+        NelderMeadFarmWorker(const std::function<double(const std::vector<double>&)> & inEvalFunc);
+        ~NelderMeadFarmWorker();
+
+        // public methods
+
+        // Opens the listening socket. A tcp port of 0 picks a free port, and
+        // getEndpoint then returns the endpoint actually bound.
+        bool listen(const std::string & endpoint);
+        const std::string & getEndpoint() const { return boundEndpoint; }
+
+        // Serves one coordinator at a time until a Shutdown frame arrives or stop
+        // is called. serve blocks, start runs it on a background thread. Once
+        // stopped, a worker finishes the evaluation it is running but does not
+        // answer any other point it was sent.
+        void serve();
+        void start();
+        void stop();
+
+        void setHeartbeatInterval(uint32_t inMilliseconds) { configHeartbeatInterval = inMilliseconds; }
+
+        // Evaluate frames holding more doubles than this end the connection
+        void setMaxPointSize(uint32_t inValue) { configMaxPointSize = inValue; }
+
+
+    private:
+        uint32_t configHeartbeatInterval = 250;
+        uint32_t configMaxPointSize = 1 << 20;
+
+        std::function<double(const std::vector<double>&)> evalFunc;
+        NelderMeadSocket listener;
+        std::string boundEndpoint;
+        std::string unixPath;
+        std::atomic<bool> stopping{ false };
+        std::thread serveThread;
+
+        // private methods
+
+        bool doServeConnection(NelderMeadSocket connection);
+};
+
+
+// The coordinator side of a farm. Its evaluate methods fit both the evaluation
+// function and the batch evaluation function of a solver:
+//
+//     NelderMeadEvalFarm farm({ "tcp:10.0.0.5:7000", "tcp:10.0.0.6:7000" });
+//     NelderMead solver(size, [&](const std::vector<double>& x) { return farm.evaluate(x); }, nullptr);
+//     solver.setBatchEvalFunc([&](uint32_t n, const std::vector<double>* const* p, double* v) {
+//         farm.evaluate(n, p, v);
+//     });
+//
+// Each worker may have several evaluations in flight. New work goes to the worker
+// with the fewest outstanding evaluations. A worker that closes its connection,
+// sends a frame that is not valid, or is silent for longer than the heartbeat
+// timeout while it has work, is dropped and its outstanding points are sent to
+// the others.
+class NelderMeadEvalFarm
+{
+    public:
+        // Constructors and destructor
+
+        NelderMeadEvalFarm(const std::vector<std::string> & inEndpoints);
+        ~NelderMeadEvalFarm();
+
+        // public methods
+
+        // Connects to every endpoint that is not currently connected and returns
+        // the number of workers connected afterwards. Called by the constructor.
+        uint32_t connect();
+        uint32_t getWorkerCount() const;
+
+        // Evaluates the points and writes their values. Throws std::runtime_error
+        // if every worker is lost before the values are in.
+        void evaluate(uint32_t count, const std::vector<double>* const* points, double * values);
+        double evaluate(const std::vector<double> & point);
+
+        // Asks every connected worker to shut down and closes the connections
+        void shutdown();
+
+        void setPipelineDepth(uint32_t inValue) { configPipelineDepth = inValue < 1 ? 1 : inValue; }
+        void setHeartbeatTimeout(uint32_t inMilliseconds) { configHeartbeatTimeout = inMilliseconds; }
+
+
+    private:
+        uint32_t configPipelineDepth = 4;
+        uint32_t configHeartbeatTimeout = 2000;
+
+        struct Worker {
+            std::string endpoint;
+            NelderMeadSocket socket;
+            bool connected = false;
+            std::vector<uint64_t> outstanding;      // ids of points sent but not answered
+            std::vector<char> input;                // bytes received but not yet parsed
+            std::chrono::steady_clock::time_point lastHeard;
+        };
+
+        std::vector<Worker> workers;
+        uint64_t nextId = 0;
+        std::vector<char> frame;        // an outgoing frame being assembled
+
+        // private methods
+
+        void doDrop(Worker & worker, std::vector<uint32_t> & queue, uint64_t firstId);
+};
@@ -0,0 +1,305 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+
+    This code was originally derived from the Nelder-Mead algorithm as
+    implemented by Michael F. Hutt whose code can be found at
+    https://github.com/huttmf/nelder-mead and was licensed under the
+    MIT license and Copyright (c) 1997 Michael F. Hutt
+ **********************************************************************/
+
+#pragma once
+
+// system headers
+#include <stddef.h>
+#include <stdint.h>
+
+// std library headers
+#include <array>
+#include <limits>
+
+
+// A Nelder-Mead solver for a number of variables known at compile time. It
+// follows the same steps as NelderMead but holds everything in std::array and
+// takes its evaluation and constraint functions as template parameters, so
+// with constexpr functions a whole search can run at compile time:
+//
+//     constexpr auto fit = fixedNelderMead<2>(
+//         [](const std::array<double, 2> & x) { return ...; },
+//         std::array<double, 2>{ 1.0, 1.0 }, 1.0e-10, 1.0);
+//     static_assert(fit.min < 1.0e-8, "calibration did not converge");
+//
+// Requires C++17.
+
+template <size_t N>
+struct FixedNelderMeadResults {
+    uint32_t iterationCount = 0;
+    uint32_t evalCount = 0;
+    std::array<double, N> minValues{};
+    double min = 0.0;
+};
+
+// Constraint function used when there is none
+struct FixedNelderMeadNoConstraint {
+    template <size_t N>
+    constexpr void operator()(std::array<double, N> &) const {}
+};
+
+// Square root usable in constant expressions. Newton's method from a starting
+// guess above the root, which decreases until it stops changing. Infinity and
+// NaN are returned unchanged, as there is nothing for the iteration to do.
+constexpr double fixedNelderMeadSqrt(double x)
+{
+    if (x != x || x > std::numeric_limits<double>::max()) {
+        return x;
+    }
+    if (!(x > 0.0)) {
+        return 0.0;
+    }
+    double r = x > 1.0 ? x : 1.0;
+    while (true) {
+        double next = 0.5 * (r + x / r);
+        if (next >= r) {
+            return r;
+        }
+        r = next;
+    }
+}
+
+template <size_t N, typename EvalFunc, typename ConstrainFunc = FixedNelderMeadNoConstraint>
+class FixedNelderMead
+{
+    public:
+        using Point = std::array<double, N>;
+
+        // Constructors and destructor
+
+        constexpr FixedNelderMead(const EvalFunc & inEvalFunc, const ConstrainFunc & inConstrainFunc = ConstrainFunc())
+            : evalFunc(inEvalFunc), constrainFunc(inConstrainFunc)
+        {
+        }
+
+        // public methods
+
+        constexpr void exec(const Point & start, double tolerance, double scale);
+        constexpr const FixedNelderMeadResults<N> & getLastExecResults() const { return lastExecResults; }
+        constexpr void setMaxIterations(uint32_t inValue) { configMaxIterations = inValue; }
+        constexpr void setReflectionCoefficient(double inValue) { configReflectionCoefficient = inValue; }
+        constexpr void setContractionCoefficient(double inValue) { configContractionCoefficient = inValue; }
+        constexpr void setExpansionCoefficient(double inValue) { configExpansionCoefficient = inValue; }
+
+
+    private:
+        // Configuration values that can be modified by the user prior to an exec call
+
+        uint32_t configMaxIterations = 1000;
+        double configReflectionCoefficient = 1.0;
+        double configContractionCoefficient = 0.5;
+        double configExpansionCoefficient = 2.0;
+
+        // Core definition of an instantiation of the algorithm
+
+        EvalFunc evalFunc;
+        ConstrainFunc constrainFunc;
+
+        std::array<Point, N + 1> v{};   // holds vertices of simplex
+        std::array<double, N + 1> f{};  // value of function at each vertex
+        Point vr{};     // reflection - coordinates
+        Point ve{};     // expansion - coordinates
+        Point vc{};     // contraction - coordinates
+        Point vm{};     // centroid - coordinates
+
+        // Current execution state. Reset on every exec call.
+
+        uint32_t evalCount = 0;
+        size_t vs = 0;          // index of vertex with smallest value
+        size_t vh = 0;          // index of vertex with next smallest value
+        size_t vg = 0;          // index of vertex with largest value
+
+        FixedNelderMeadResults<N> lastExecResults{};
+
+        // private methods
+
+        constexpr double doEvaluate(const Point & x)
+        {
+            evalCount++;
+            return evalFunc(x);
+        }
+
+        constexpr void doIndexes();
+        constexpr void doTrialPoint(Point & out, const Point & toward, double coefficient);
+        constexpr void doAccept(const Point & point, double value);
+};
+
+
+template <size_t N, typename EvalFunc, typename ConstrainFunc>
+constexpr void FixedNelderMead<N, EvalFunc, ConstrainFunc>::doIndexes()
+{
+    vh = vs;
+    for (size_t j = 0; j <= N; j++) {
+        if (f[j] > f[vg]) {
+            vg = j;
+        }
+        if (f[j] < f[vs]) {
+            vs = j;
+        }
+    }
+    vh = vs;
+    for (size_t j = 0; j <= N; j++) {
+        if (f[j] > f[vh] && f[j] < f[vg]) {
+            vh = j;
+        }
+    }
+}
+
+template <size_t N, typename EvalFunc, typename ConstrainFunc>
+constexpr void FixedNelderMead<N, EvalFunc, ConstrainFunc>::doTrialPoint(Point & out, const Point & toward, double coefficient)
+{
+    for (size_t j = 0; j < N; j++) {
+        out[j] = vm[j] + coefficient * (toward[j] - vm[j]);
+    }
+}
+
+template <size_t N, typename EvalFunc, typename ConstrainFunc>
+constexpr void FixedNelderMead<N, EvalFunc, ConstrainFunc>::doAccept(const Point & point, double value)
+{
+    v[vg] = point;
+    f[vg] = value;
+}
+
+template <size_t N, typename EvalFunc, typename ConstrainFunc>
+constexpr void FixedNelderMead<N, EvalFunc, ConstrainFunc>::exec(const Point & start, double tolerance, double scale)
+{
+    evalCount = 0;
+    vs = 0;
+    vh = 0;
+    vg = 0;
+
+    // set up the initial simplex around the start point, constrained
+    double pn = scale * (fixedNelderMeadSqrt(N + 1.0) - 1 + N) / (N * fixedNelderMeadSqrt(2.0));
+    double qn = scale * (fixedNelderMeadSqrt(N + 1.0) - 1) / (N * fixedNelderMeadSqrt(2.0));
+
+    v[0] = start;
+    for (size_t i = 1; i <= N; i++) {
+        for (size_t j = 0; j < N; j++) {
+            v[i][j] = (i - 1 == j ? pn : qn) + start[j];
+        }
+    }
+    for (size_t j = 0; j <= N; j++) {
+        constrainFunc(v[j]);
+        f[j] = doEvaluate(v[j]);
+    }
+
+    uint32_t iterationCount = 0;
+    while (++iterationCount <= configMaxIterations) {
+        doIndexes();
+
+        // centroid of all vertices except vg
+        for (size_t j = 0; j < N; j++) {
+            double cent = 0.0;
+            for (size_t m = 0; m <= N; m++) {
+                if (m != vg) {
+                    cent += v[m][j];
+                }
+            }
+            vm[j] = cent / N;
+        }
+
+        // reflect vg
+        doTrialPoint(vr, v[vg], -configReflectionCoefficient);
+        constrainFunc(vr);
+        double fr = doEvaluate(vr);
+        if (fr < f[vh] && fr >= f[vs]) {
+            doAccept(vr, fr);
+        }
+
+        // investigate a step further in this direction
+        if (fr < f[vs]) {
+            doTrialPoint(ve, vr, configExpansionCoefficient);
+            constrainFunc(ve);
+            double fe = doEvaluate(ve);
+            if (fe < fr) {
+                doAccept(ve, fe);
+            }
+            else {
+                doAccept(vr, fr);
+            }
+        }
+
+        // check to see if a contraction is necessary
+        if (fr >= f[vh]) {
+            if (fr < f[vg] && fr >= f[vh]) {
+                doTrialPoint(vc, vr, configContractionCoefficient);
+            }
+            else {
+                doTrialPoint(vc, v[vg], configContractionCoefficient);
+            }
+            constrainFunc(vc);
+            double fc = doEvaluate(vc);
+
+            if (fc < f[vg]) {
+                doAccept(vc, fc);
+            }
+            else {
+                // halve the distance from vs to all the other vertices
+                for (size_t row = 0; row <= N; row++) {
+                    if (row != vs) {
+                        for (size_t j = 0; j < N; j++) {
+                            v[row][j] = v[vs][j] + (v[row][j] - v[vs][j]) / 2.0;
+                        }
+                    }
+                }
+                for (size_t j = 0; j <= N; j++) {
+                    f[j] = doEvaluate(v[j]);
+                }
+                doIndexes();
+
+                constrainFunc(v[vg]);
+                f[vg] = doEvaluate(v[vg]);
+                constrainFunc(v[vh]);
+                f[vh] = doEvaluate(v[vh]);
+            }
+        }
+
+        // test for convergence
+        double fsum = 0.0;
+        for (size_t j = 0; j <= N; j++) {
+            fsum += f[j];
+        }
+        double favg = fsum / (N + 1);
+        double s = 0.0;
+        for (size_t j = 0; j <= N; j++) {
+            s += (f[j] - favg) * (f[j] - favg) / N;
+        }
+        if (fixedNelderMeadSqrt(s) < tolerance) {
+            break;
+        }
+    }
+
+    doIndexes();
+
+    lastExecResults.min = doEvaluate(v[vs]);
+    lastExecResults.evalCount = evalCount;
+    lastExecResults.iterationCount = iterationCount;
+    lastExecResults.minValues = v[vs];
+}
+
+// Runs a single search and returns its results. Usable to initialize constexpr
+// variables when the evaluation and constraint functions are constexpr.
+template <size_t N, typename EvalFunc, typename ConstrainFunc = FixedNelderMeadNoConstraint>
+constexpr FixedNelderMeadResults<N> fixedNelderMead(
+    EvalFunc evalFunc,
+    const std::array<double, N> & start,
+    double tolerance,
+    double scale,
+    uint32_t maxIterations = 1000,
+    ConstrainFunc constrainFunc = ConstrainFunc()
+)
+{
+    FixedNelderMead<N, EvalFunc, ConstrainFunc> solver(evalFunc, constrainFunc);
+    solver.setMaxIterations(maxIterations);
+    solver.exec(start, tolerance, scale);
+    return solver.getLastExecResults();
+}
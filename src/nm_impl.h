@@ -0,0 +1,733 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+
+    This code was originally derived from the Nelder-Mead algorithm as 
+    implemented by Michael F. Hutt whose code can be found at
+    https://github.com/huttmf/nelder-mead and was licensed under the
+    MIT license and Copyright (c) 1997 Michael F. Hutt
+ **********************************************************************/
+
+// Member definitions of BasicNelderMead. Included at the end of nm.h so that
+// solvers with custom policies can be instantiated by any translation unit.
+
+#pragma once
+
+#include <math.h>
+#if NELDER_MEAD_DEBUG
+#include <stdio.h>
+#endif
+
+
+template <typename Policies>
+BasicNelderMead<Policies>::BasicNelderMead(
+    uint32_t inSize,
+    const std::function<double(const std::vector<double>&)> & inEvalFunc,
+    const Constraint & inConstraint,
+    const Callback & inCallback,
+    const Instrumentation & inInstrumentation
+)
+    : constraint(inConstraint), callback(inCallback), instrumentation(inInstrumentation)
+{
+    size = inSize;
+    evalFunc = inEvalFunc;
+
+    v.resize(size + 1);
+    for (uint32_t i = 0; i <= size; i++) {
+        v[i].resize(size);
+    }
+    f.resize(size + 1);
+    vr.resize(size);
+    ve.resize(size);
+    vc.resize(size);
+    vm.resize(size);
+    pending.resize(size + 1);
+    pendingValues.resize(size + 1);
+    pendingContext.resize(size + 1);
+    vertexId.resize(size + 1);
+    shrunkId.resize(size + 1);
+
+    centroid.resize(*this);
+    convergence.resize(*this);
+}
+
+template <typename Policies>
+BasicNelderMead<Policies>::~BasicNelderMead()
+{
+}
+
+
+template <typename Policies>
+void BasicNelderMead<Policies>::setThreadCount(uint32_t inValue)
+{
+    if (inValue <= 1) {
+        pool.reset();
+    }
+    else if (!pool || pool->getThreadCount() != inValue) {
+        pool.reset(new NelderMeadThreadPool(inValue));
+    }
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::doParallelRange(uint32_t count, uint32_t chunkSize, void (*call)(const void*, uint32_t, uint32_t), const void * func) const
+{
+    uint32_t chunks = (count + chunkSize - 1) / chunkSize;
+    pool->run(chunks, [&](uint32_t chunk) {
+        uint32_t begin = chunk * chunkSize;
+        uint32_t end = begin + chunkSize < count ? begin + chunkSize : count;
+        call(func, begin, end);
+    });
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::doParallelBlocks(uint32_t blocks, void (*call)(const void*, uint32_t), const void * func) const
+{
+    pool->run(blocks, [&](uint32_t block) {
+        call(func, block);
+    });
+}
+
+
+template <typename Policies>
+void BasicNelderMead<Policies>::doInitialize(const std::vector<double> & start, double scale)
+{
+    double pn, qn;
+
+    evalCount = 0;
+
+    vs = 0;         // vertex with smallest value
+    vh = 0;         // vertex with next smallest value
+    vg = 0;         // vertex with largest value
+
+    pn = scale * (sqrt(size + 1) - 1 + size) / (size * sqrt(2));
+    qn = scale * (sqrt(size + 1) - 1) / (size * sqrt(2));
+
+    for (uint32_t i = 0; i < size; i++) {
+        v[0][i] = start[i];
+    }
+
+    for (uint32_t i = 1; i <= size; i++) {
+        for (uint32_t j = 0; j < size; j++) {
+            if (i - 1 == j) {
+                v[i][j] = pn + start[j];
+            }
+            else {
+                v[i][j] = qn + start[j];
+            }
+        }
+    }
+}
+
+
+#if NELDER_MEAD_DEBUG
+template <typename Policies>
+void BasicNelderMead<Policies>::doPrintStart()
+{
+    printf("Initial Values\n");
+    for (uint32_t j = 0; j <= size; j++) {
+        for (uint32_t i = 0; i < size; i++) {
+            printf("%f, ", v[j][i]);
+        }
+        printf("value %f\n", f[j]);
+    }
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::doPrintIteration(uint32_t itr)
+{
+    printf("Iteration %d\n", itr);
+    for (uint32_t j = 0; j <= size; j++) {
+        for (uint32_t i = 0; i < size; i++) {
+            printf("%f %f\n", v[j][i], f[j]);
+        }
+    }
+}
+#endif
+
+template <typename Policies>
+inline void BasicNelderMead<Policies>::doTrialPoint(std::vector<double>& out, const std::vector<double>& toward, double coefficient)
+{
+    // out = vm + coefficient * (toward - vm). Reflection and inside contraction
+    // move away from vg, which is expressed through a negative coefficient.
+    forRange(size, elementChunk, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t j = begin; j < end; j++) {
+            out[j] = vm[j] + coefficient * (toward[j] - vm[j]);
+        }
+    });
+}
+
+template <typename Policies>
+inline void BasicNelderMead<Policies>::doAccept(const std::vector<double>& point, double value, uint64_t id)
+{
+    // The point being replaced is retired, unless it is a trial point of this
+    // iteration. Those are settled once the iteration is complete.
+    if (trackIds) {
+        uint64_t old = vertexId[vg];
+        bool oldIsTrial = false;
+        for (uint32_t t = 0; t < trialCount; t++) {
+            oldIsTrial = oldIsTrial || trialIds[t] == old;
+        }
+        if (!oldIsTrial) {
+            doRetire(old);
+        }
+        vertexId[vg] = id;
+    }
+
+    centroid.replace(*this, point);
+    forRange(size, elementChunk, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t j = begin; j < end; j++) {
+            v[vg][j] = point[j];
+        }
+    });
+    f[vg] = value;
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::doShrink()
+{
+    // halve the distance from vs to all the other vertices of the simplex
+    forRange(size + 1, rowChunk, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t row = begin; row < end; row++) {
+            if (row != vs) {
+                for (uint32_t j = 0; j <= size - 1; j++) {
+                    v[row][j] = v[vs][j] + (v[row][j] - v[vs][j]) / 2.0;
+                }
+            }
+        }
+    });
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::doPendAll(bool fromStart)
+{
+    // Every vertex becomes a new point. The vertices of the initial simplex
+    // have no parent, as none of them has been evaluated yet. Those of a shrunk
+    // simplex descend from the point they were shrunk from.
+    for (uint32_t j = 0; j <= size; j++) {
+        shrunkId[j] = vertexId[j];
+        vertexId[j] = nextPointId++;
+        pending[j] = &v[j];
+        pendingContext[j].pointId = vertexId[j];
+        pendingContext[j].parentId = fromStart ? 0 : shrunkId[j];
+    }
+    pendingCount = size + 1;
+}
+
+template <typename Policies>
+uint64_t BasicNelderMead<Policies>::doPend(const std::vector<double>& point, uint64_t parent)
+{
+    pending[0] = &point;
+    pendingCount = 1;
+    if (!trackIds) {
+        return 0;
+    }
+    pendingContext[0].pointId = nextPointId++;
+    pendingContext[0].parentId = parent;
+    return pendingContext[0].pointId;
+}
+
+template <typename Policies>
+uint64_t BasicNelderMead<Policies>::doPendTrial(const std::vector<double>& point, uint64_t parent)
+{
+    uint64_t id = doPend(point, parent);
+    if (trackIds) {
+        trialIds[trialCount++] = id;
+    }
+    return id;
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::doSettleTrials()
+{
+    // Trial points end up either as the new vg or not at all
+    for (uint32_t t = 0; t < trialCount; t++) {
+        if (trialIds[t] != vertexId[vg]) {
+            doRetire(trialIds[t]);
+        }
+    }
+    trialCount = 0;
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::doFinish()
+{
+    // calculate significant indexes of the simplex
+    // and evaluate the minimum
+    doIndexes();
+    doPend(v[vs], vertexId[vs]);
+    phase = Phase::Final;
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::exec(const std::vector<double> & inStart, double tolerancee, double scale)
+{
+    // This function can be called many times for the same instance of the class
+    // so we have to initialize it every time.
+    doInitialize(inStart, scale);
+    doBeginSearch(tolerancee, contextEvalFunc || batchContextEvalFunc || retireFunc);
+    doRun();
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::exec(const std::vector<std::vector<double>> & inSimplex, double tolerancee)
+{
+    doCopySimplex(inSimplex);
+    doBeginSearch(tolerancee, contextEvalFunc || batchContextEvalFunc || retireFunc);
+    doRun();
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::doRun()
+{
+    // The common case, a plain evaluation function with nothing watching the
+    // point ids, runs as a loop rather than through tell
+    if (!trackIds && !batchEvalFunc) {
+        doDirectRun();
+        return;
+    }
+
+    while (!isDone()) {
+        if (batchContextEvalFunc && (pendingCount > 1 || !contextEvalFunc)) {
+            batchContextEvalFunc(pendingCount, pending.data(), pendingContext.data(), pendingValues.data());
+        }
+        else if (contextEvalFunc) {
+            for (uint32_t i = 0; i < pendingCount; i++) {
+                pendingValues[i] = contextEvalFunc(*pending[i], pendingContext[i]);
+            }
+        }
+        else if (batchEvalFunc && pendingCount > 1) {
+            batchEvalFunc(pendingCount, pending.data(), pendingValues.data());
+        }
+        else {
+            for (uint32_t i = 0; i < pendingCount; i++) {
+                pendingValues[i] = evalFunc(*pending[i]);
+            }
+        }
+        tell(pendingValues.data());
+    }
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::doDirectRun()
+{
+    // The same search as tell makes, step for step, with the points evaluated
+    // where they are made. Any change to one has to be made to the other.
+    for (uint32_t j = 0; j <= size; j++) {
+        f[j] = doEvaluate(v[j]);
+    }
+
+#if NELDER_MEAD_DEBUG
+    // print out the initial values
+    doPrintStart();
+#endif
+
+    // The loop that converges (maybe) on a what is being sought
+    while (++iterationCount <= maxIterations) {
+
+        // calculate the  indexes of significant vertices of the simplex
+        // that will be used in subsequent calculations. 
+        doIndexes();
+
+        // calculate the centroid of the simplex
+        centroid.compute(*this, vm);
+
+        // reflect vg to new vertex vr. The reflection might need to be constrained.
+        doTrialPoint(vr, v[vg], -reflectionCoefficient);
+        constraint.constrain(vr);
+
+        // recalculate the simplex values
+        fr = doEvaluate(vr);
+        if (fr < f[vh] && fr >= f[vs]) {
+            doAccept(vr, fr, 0);
+            instrumentation.step(NelderMeadStep::Reflection);
+        }
+
+        // investigate a step further in this direction 
+        if (fr < f[vs]) {
+            doTrialPoint(ve, vr, expansionCoefficient);
+            constraint.constrain(ve);
+            double fe = doEvaluate(ve);
+
+            if (strategy == NelderMeadStrategy::RepeatedExpansion) {
+                // keep each improved point in vr and push on past it
+                expansionCount = 0;
+                while (fe < fr && expansionCount < maxExpansions) {
+                    vr.swap(ve);
+                    fr = fe;
+                    expansionCount++;
+
+                    doTrialPoint(ve, vr, expansionGrowth);
+                    constraint.constrain(ve);
+                    fe = doEvaluate(ve);
+                }
+                if (fe < fr) {
+                    expansionCount++;
+                    doAccept(ve, fe, 0);
+                }
+                else {
+                    doAccept(vr, fr, 0);
+                }
+                instrumentation.step(expansionCount > 0 ? NelderMeadStep::Expansion : NelderMeadStep::Reflection);
+            }
+            else if (fe < (strategy == NelderMeadStrategy::GreedyExpansion ? f[vs] : fr)) {
+                doAccept(ve, fe, 0);
+                instrumentation.step(NelderMeadStep::Expansion);
+            }
+            else {
+                doAccept(vr, fr, 0);
+                instrumentation.step(NelderMeadStep::Reflection);
+            }
+        }
+
+        // check to see if a contraction is necessary 
+        if (fr >= f[vh]) {
+            if (fr < f[vg] && fr >= f[vh] && strategy != NelderMeadStrategy::InsideContractionOnly) {
+                // perform outside contraction 
+                doTrialPoint(vc, vr, contractionCoefficient);
+                contraction = NelderMeadStep::OutsideContraction;
+            }
+            else {
+                // perform inside contraction 
+                doTrialPoint(vc, v[vg], contractionCoefficient);
+                contraction = NelderMeadStep::InsideContraction;
+            }
+            constraint.constrain(vc);
+            double fc = doEvaluate(vc);
+
+            if (fc < f[vg]) {
+                doAccept(vc, fc, 0);
+                instrumentation.step(contraction);
+            }
+            else {
+                // at this point the contraction is not successful,
+                // we must halve the distance from vs to all the
+                // vertices of the simplex and then continue.
+                doShrink();
+                instrumentation.step(NelderMeadStep::Shrink);
+
+                // re-evaluate all the vertices 
+                for (uint32_t j = 0; j <= size; j++) {
+                    f[j] = doEvaluate(v[j]);
+                }
+
+                // calculate significant indexes of the simplex
+                doIndexes();
+
+                constraint.constrain(v[vg]);
+                f[vg] = doEvaluate(v[vg]);
+                constraint.constrain(v[vh]);
+                f[vh] = doEvaluate(v[vh]);
+                centroid.reset(*this);
+            }
+        }
+
+        // print out the value at each iteration
+#if NELDER_MEAD_DEBUG
+        doPrintIteration(iterationCount);
+#endif
+
+        // test for convergence
+        if (convergence.converged(*this, tolerance) || !callback.iteration(*this)) {
+            break;
+        }
+    }
+
+    // calculate significant indexes of the simplex
+    doIndexes();
+
+    // evaluate the minimum  and stuff the results
+    lastExecResults.min = doEvaluate(v[vs]);
+    lastExecResults.evalCount = evalCount;
+    lastExecResults.iterationCount = iterationCount;
+    lastExecResults.minValues.clear();
+    for (uint32_t j = 0; j < size; j++) {
+        lastExecResults.minValues.push_back(v[vs][j]);
+    }
+    pendingCount = 0;
+    phase = Phase::Done;
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::start(const std::vector<double> & inStart, double tolerancee, double scale)
+{
+    doInitialize(inStart, scale);
+    doBeginSearch(tolerancee, true);
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::start(const std::vector<std::vector<double>> & inSimplex, double tolerancee)
+{
+    doCopySimplex(inSimplex);
+    doBeginSearch(tolerancee, true);
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::doCopySimplex(const std::vector<std::vector<double>> & inSimplex)
+{
+    evalCount = 0;
+    vs = 0;
+    vh = 0;
+    vg = 0;
+
+    for (uint32_t i = 0; i <= size; i++) {
+        for (uint32_t j = 0; j < size; j++) {
+            v[i][j] = inSimplex[i][j];
+        }
+    }
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::doBeginSearch(double tolerancee, bool inTrackIds)
+{
+    instrumentation.start();
+    tolerance = tolerancee;
+    maxIterations = configMaxIterations;
+    reflectionCoefficient = configReflectionCoefficient;
+    contractionCoefficient = configContractionCoefficient;
+    expansionCoefficient = configExpansionCoefficient;
+    strategy = configStrategy;
+    expansionGrowth = configExpansionGrowth;
+    trackIds = inTrackIds;
+    iterationCount = 0;
+
+    // The starting values that we were passed might not actually obey the constraint
+    // function that was provided. Silly caller. So we constrain them here.
+    for (uint32_t j = 0; j <= size; j++) {
+        constraint.constrain(v[j]);
+    }
+    centroid.reset(*this);
+
+    // find the initial function values based on the freshly constraine starting values
+    trialCount = 0;
+    doPendAll(true);
+    phase = Phase::Initial;
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::doBeginIteration()
+{
+    // The loop that converges (maybe) on a what is being sought
+    if (++iterationCount > maxIterations) {
+        doFinish();
+        return;
+    }
+
+    // calculate the  indexes of significant vertices of the simplex
+    // that will be used in subsequent calculations. 
+    doIndexes();
+
+    // calculate the centroid of the simplex
+    centroid.compute(*this, vm);
+
+    // reflect vg to new vertex vr. The reflection might need to be constrained.
+    doTrialPoint(vr, v[vg], -reflectionCoefficient);
+    constraint.constrain(vr);
+
+    vrId = doPendTrial(vr, vertexId[vs]);
+    phase = Phase::Reflect;
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::doContractionCheck()
+{
+    // check to see if a contraction is necessary 
+    if (fr >= f[vh]) {
+        if (fr < f[vg] && fr >= f[vh] && strategy != NelderMeadStrategy::InsideContractionOnly) {
+            // perform outside contraction 
+            doTrialPoint(vc, vr, contractionCoefficient);
+            contraction = NelderMeadStep::OutsideContraction;
+            constraint.constrain(vc);
+            vcId = doPendTrial(vc, vrId);
+        }
+        else {
+            // perform inside contraction 
+            doTrialPoint(vc, v[vg], contractionCoefficient);
+            contraction = NelderMeadStep::InsideContraction;
+            constraint.constrain(vc);
+            vcId = doPendTrial(vc, vertexId[vg]);
+        }
+
+        phase = Phase::Contract;
+        return;
+    }
+
+    doEndIteration();
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::doEndIteration()
+{
+    doSettleTrials();
+
+    // print out the value at each iteration
+#if NELDER_MEAD_DEBUG
+    doPrintIteration(iterationCount);
+#endif
+
+    // test for convergence
+    if (convergence.converged(*this, tolerance) || !callback.iteration(*this)) {
+        doFinish();
+        return;
+    }
+
+    doBeginIteration();
+}
+
+template <typename Policies>
+void BasicNelderMead<Policies>::tell(const double * values)
+{
+    evalCount += pendingCount;
+    for (uint32_t i = 0; i < pendingCount; i++) {
+        instrumentation.evaluated(values[i]);
+    }
+
+    switch (phase) {
+        case Phase::Initial:
+            for (uint32_t j = 0; j <= size; j++) {
+                f[j] = values[j];
+            }
+#if NELDER_MEAD_DEBUG
+            // print out the initial values
+            doPrintStart();
+#endif
+            doBeginIteration();
+            break;
+
+        case Phase::Reflect:
+            // recalculate the simplex values
+            fr = values[0];
+            if (fr < f[vh] && fr >= f[vs]) {
+                doAccept(vr, fr, vrId);
+                instrumentation.step(NelderMeadStep::Reflection);
+            }
+
+            // investigate a step further in this direction 
+            if (fr < f[vs]) {
+                doTrialPoint(ve, vr, expansionCoefficient);
+                constraint.constrain(ve);
+
+                veId = doPendTrial(ve, vrId);
+                expansionCount = 0;
+                phase = Phase::Expand;
+                break;
+            }
+
+            doContractionCheck();
+            break;
+
+        case Phase::Expand:
+            if (strategy == NelderMeadStrategy::RepeatedExpansion) {
+                if (values[0] < fr && expansionCount < maxExpansions) {
+                    // keep the improved point in vr and push on past it
+                    doRetire(vrId);
+                    vr.swap(ve);
+                    vrId = veId;
+                    fr = values[0];
+                    expansionCount++;
+                    if (trackIds) {
+                        trialIds[0] = vrId;
+                        trialCount = 1;
+                    }
+
+                    doTrialPoint(ve, vr, expansionGrowth);
+                    constraint.constrain(ve);
+                    veId = doPendTrial(ve, vrId);
+                    break;
+                }
+                if (values[0] < fr) {
+                    expansionCount++;
+                    doAccept(ve, values[0], veId);
+                }
+                else {
+                    doAccept(vr, fr, vrId);
+                }
+                instrumentation.step(expansionCount > 0 ? NelderMeadStep::Expansion : NelderMeadStep::Reflection);
+            }
+            else if (values[0] < (strategy == NelderMeadStrategy::GreedyExpansion ? f[vs] : fr)) {
+                doAccept(ve, values[0], veId);
+                instrumentation.step(NelderMeadStep::Expansion);
+            }
+            else {
+                doAccept(vr, fr, vrId);
+                instrumentation.step(NelderMeadStep::Reflection);
+            }
+
+            doContractionCheck();
+            break;
+
+        case Phase::Contract:
+            if (values[0] < f[vg]) {
+                doAccept(vc, values[0], vcId);
+                instrumentation.step(contraction);
+                doEndIteration();
+                break;
+            }
+
+            // at this point the contraction is not successful,
+            // we must halve the distance from vs to all the
+            // vertices of the simplex and then continue.
+            doSettleTrials();
+            doShrink();
+            instrumentation.step(NelderMeadStep::Shrink);
+
+            // re-evaluate all the vertices 
+            doPendAll(false);
+            phase = Phase::ShrinkAll;
+            break;
+
+        case Phase::ShrinkAll:
+            for (uint32_t j = 0; j <= size; j++) {
+                f[j] = values[j];
+                doRetire(shrunkId[j]);
+            }
+
+            // calculate significant indexes of the simplex
+            doIndexes();
+
+            constraint.constrain(v[vg]);
+            shrunkId[0] = vertexId[vg];
+            vertexId[vg] = doPend(v[vg], shrunkId[0]);
+            phase = Phase::ShrinkWorst;
+            break;
+
+        case Phase::ShrinkWorst:
+            f[vg] = values[0];
+            doRetire(shrunkId[0]);
+            constraint.constrain(v[vh]);
+            shrunkId[0] = vertexId[vh];
+            vertexId[vh] = doPend(v[vh], shrunkId[0]);
+            phase = Phase::ShrinkNext;
+            break;
+
+        case Phase::ShrinkNext:
+            f[vh] = values[0];
+            doRetire(shrunkId[0]);
+            centroid.reset(*this);
+            doEndIteration();
+            break;
+
+        case Phase::Final:
+            // stuff the results
+            lastExecResults.min = values[0];
+            lastExecResults.evalCount = evalCount;
+            lastExecResults.iterationCount = iterationCount;
+            lastExecResults.minValues.clear();
+            for (uint32_t j = 0; j < size; j++) {
+                lastExecResults.minValues.push_back(v[vs][j]);
+            }
+            pendingCount = 0;
+            phase = Phase::Done;
+
+            // nothing is held once the search is over
+            doRetire(pendingContext[0].pointId);
+            for (uint32_t j = 0; j <= size; j++) {
+                doRetire(vertexId[j]);
+            }
+            break;
+
+        case Phase::Done:
+            break;
+    }
+}
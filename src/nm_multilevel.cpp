@@ -0,0 +1,193 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#include "nm_multilevel.h"
+
+#include <math.h>
+
+#include <stdexcept>
+
+
+// A candidate edge direction is kept if this much of its length is left after
+// removing the directions already chosen
+static const double independentDirection = 1.0e-6;
+
+
+NelderMeadMultilevel::NelderMeadMultilevel(const std::function<double(const std::vector<double>&)> & inEvalFunc)
+{
+    evalFunc = inEvalFunc;
+}
+
+NelderMeadMultilevel::~NelderMeadMultilevel()
+{
+}
+
+
+uint32_t NelderMeadMultilevel::addLevel(const NelderMeadLevel & level)
+{
+    uint32_t index = (uint32_t)levels.size();
+
+    if (level.size == 0) {
+        throw std::invalid_argument("NelderMeadMultilevel: a level needs at least one variable");
+    }
+    if (index > 0 && (!level.prolongFunc || !level.restrictFunc)) {
+        throw std::invalid_argument("NelderMeadMultilevel: every level above the coarsest needs a prolongation and a restriction");
+    }
+
+    levels.push_back(level);
+    points.emplace_back(level.size);
+    solvers.emplace_back(new NelderMead(level.size, [this, index](const std::vector<double> & x) {
+        return evalFunc(doProlong(index, x));
+    }, nullptr));
+    return index;
+}
+
+const std::vector<double> & NelderMeadMultilevel::doProlong(uint32_t level, const std::vector<double> & point)
+{
+    const std::vector<double> * current = &point;
+    for (uint32_t k = level + 1; k < (uint32_t)levels.size(); k++) {
+        levels[k].prolongFunc(*current, points[k]);
+        current = &points[k];
+    }
+    return *current;
+}
+
+void NelderMeadMultilevel::doSimplex(uint32_t level, const std::vector<double> & coarseMin, double scale, std::vector<std::vector<double>> & simplex)
+{
+    uint32_t coarseSize = levels[level - 1].size;
+    uint32_t size = levels[level].size;
+
+    simplex.resize(size + 1);
+    for (auto & vertex : simplex) {
+        vertex.resize(size);
+    }
+    levels[level].prolongFunc(coarseMin, simplex[0]);
+
+    // Orthonormal edge directions, first those of the prolonged coarse
+    // coordinates and then those of the fine coordinates, skipping any that
+    // depend on the directions before them
+    std::vector<std::vector<double>> directions;
+    std::vector<double> coarse(coarseSize, 0.0);
+    std::vector<double> candidate(size);
+
+    // prolongation can be affine, so coarse directions are taken as the
+    // difference from the prolonged origin
+    std::vector<double> origin(size);
+    levels[level].prolongFunc(coarse, origin);
+
+    for (uint32_t c = 0; c < coarseSize + size && directions.size() < size; c++) {
+        if (c < coarseSize) {
+            for (uint32_t j = 0; j < coarseSize; j++) {
+                coarse[j] = j == c ? 1.0 : 0.0;
+            }
+            levels[level].prolongFunc(coarse, candidate);
+            for (uint32_t j = 0; j < size; j++) {
+                candidate[j] -= origin[j];
+            }
+        }
+        else {
+            for (uint32_t j = 0; j < size; j++) {
+                candidate[j] = j == c - coarseSize ? 1.0 : 0.0;
+            }
+        }
+
+        double original = 0.0;
+        for (double x : candidate) {
+            original += x * x;
+        }
+        if (original == 0.0) {
+            continue;
+        }
+
+        // twice, for orthogonality to rounding
+        for (int pass = 0; pass < 2; pass++) {
+            for (auto & d : directions) {
+                double dot = 0.0;
+                for (uint32_t j = 0; j < size; j++) {
+                    dot += candidate[j] * d[j];
+                }
+                for (uint32_t j = 0; j < size; j++) {
+                    candidate[j] -= dot * d[j];
+                }
+            }
+        }
+
+        double norm = 0.0;
+        for (double x : candidate) {
+            norm += x * x;
+        }
+        if (norm <= independentDirection * independentDirection * original) {
+            continue;
+        }
+        norm = sqrt(norm);
+        for (auto & x : candidate) {
+            x /= norm;
+        }
+        directions.push_back(candidate);
+    }
+
+    // The fine coordinate directions span the whole level, so after removing
+    // any smaller subspace, what is left of one of them has a squared length
+    // of at least 1 / size, far above the threshold. This only fails if
+    // rounding has broken the orthogonalization.
+    if (directions.size() < size) {
+        throw std::runtime_error("NelderMeadMultilevel: could not build an initial simplex");
+    }
+
+    for (uint32_t i = 1; i <= size; i++) {
+        for (uint32_t j = 0; j < size; j++) {
+            simplex[i][j] = simplex[0][j] + scale * directions[i - 1][j];
+        }
+    }
+}
+
+void NelderMeadMultilevel::exec(const std::vector<double> & inStart, double tolerance, double scale)
+{
+    uint32_t count = (uint32_t)levels.size();
+
+    levelResults.clear();
+    lastExecResults.iterationCount = 0;
+    lastExecResults.evalCount = 0;
+    lastExecResults.min = HUGE_VAL;
+    lastExecResults.minValues.clear();
+    if (count == 0) {
+        throw std::invalid_argument("NelderMeadMultilevel: exec needs at least one level");
+    }
+    if (inStart.size() != levels[count - 1].size) {
+        throw std::invalid_argument("NelderMeadMultilevel: the start point must have the size of the finest level");
+    }
+
+    // restrict the start point down to the coarsest level
+    std::vector<std::vector<double>> starts(count);
+    starts[count - 1] = inStart;
+    for (uint32_t k = count - 1; k > 0; k--) {
+        starts[k - 1].resize(levels[k - 1].size);
+        levels[k].restrictFunc(starts[k], starts[k - 1]);
+    }
+
+    std::vector<std::vector<double>> simplex;
+    for (uint32_t k = 0; k < count; k++) {
+        NelderMead & solver = *solvers[k];
+        solver.setMaxIterations(configMaxIterations);
+
+        if (k == 0) {
+            solver.exec(starts[0], tolerance, scale);
+        }
+        else {
+            doSimplex(k, levelResults[k - 1].minValues, scale, simplex);
+            solver.exec(simplex, tolerance);
+        }
+        scale *= configScaleRatio;
+
+        levelResults.push_back(solver.getLastExecResults());
+        lastExecResults.iterationCount += levelResults[k].iterationCount;
+        lastExecResults.evalCount += levelResults[k].evalCount;
+    }
+
+    lastExecResults.min = levelResults[count - 1].min;
+    lastExecResults.minValues = levelResults[count - 1].minValues;
+}
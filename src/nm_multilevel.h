@@ -0,0 +1,93 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#pragma once
+
+// system headers
+#include <stdint.h>
+
+// std library headers
+#include <functional>
+#include <memory>
+#include <vector>
+
+// project headers
+#include "nm.h"
+
+
+// One resolution of a multilevel problem. prolongFunc maps a point of the next
+// coarser level to this level, for example by interpolating between knots, and
+// restrictFunc maps a point of this level to the next coarser one. Neither is
+// used for the coarsest level.
+struct NelderMeadLevel {
+    uint32_t size = 0;
+    std::function<void(const std::vector<double>& coarse, std::vector<double>& fine)> prolongFunc;
+    std::function<void(const std::vector<double>& fine, std::vector<double>& coarse)> restrictFunc;
+};
+
+// Solves a problem whose variables are a discretized curve or surface one
+// resolution at a time, from the coarsest level to the finest. The evaluation
+// function always takes a point at full resolution: points of coarser levels
+// are prolonged up to it before they are evaluated.
+//
+// The search at each finer level starts from a simplex around the prolonged
+// minimum of the level below. Its first edges follow the prolonged coordinate
+// directions of the coarser level and the rest span the detail that the coarser
+// level cannot represent, all of the same length. That length is the scale for
+// the coarsest level and shrinks by the scale ratio at every finer level.
+class NelderMeadMultilevel
+{
+    public:
+        // Constructors and destructor
+
+        NelderMeadMultilevel(const std::function<double(const std::vector<double>&)> & inEvalFunc);
+        ~NelderMeadMultilevel();
+
+        // public methods
+
+        // Levels are added from the coarsest to the finest. Returns the index of
+        // the level. Throws std::invalid_argument for a level with no variables,
+        // or for one above the coarsest without a prolongation and a restriction.
+        uint32_t addLevel(const NelderMeadLevel & level);
+
+        // start is a point at full resolution. It is restricted down to every
+        // level. Throws std::invalid_argument if there are no levels or the start
+        // point is not the size of the finest, after clearing the results.
+        void exec(const std::vector<double> & inStart, double tolerance, double scale);
+
+        // Totals over all levels, with the minimum found at full resolution
+        const NelderMeadResults & getLastExecResults() const { return lastExecResults; }
+
+        // Results of each level, coarsest first, with minValues at that level's resolution
+        const std::vector<NelderMeadResults> & getLevelResults() const { return levelResults; }
+
+        // Applies to the search at every level
+        void setMaxIterations(uint32_t inValue) { configMaxIterations = inValue; }
+        void setScaleRatio(double inValue) { configScaleRatio = inValue; }
+
+
+    private:
+        // Configuration values that can be modified by the user prior to an exec call
+
+        uint32_t configMaxIterations = 1000;
+        double configScaleRatio = 0.5;
+
+        std::function<double(const std::vector<double>&)> evalFunc;
+        std::vector<NelderMeadLevel> levels;
+        std::vector<std::unique_ptr<NelderMead>> solvers;
+
+        // A point of every level, used while prolonging to full resolution
+        std::vector<std::vector<double>> points;
+
+        std::vector<NelderMeadResults> levelResults;
+        NelderMeadResults lastExecResults;
+
+        // private methods
+
+        const std::vector<double> & doProlong(uint32_t level, const std::vector<double> & point);
+        void doSimplex(uint32_t level, const std::vector<double> & coarseMin, double scale, std::vector<std::vector<double>> & simplex);
+};
@@ -0,0 +1,359 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#pragma once
+
+// system headers
+#include <math.h>
+#include <stdint.h>
+
+// std library headers
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+// Keeps the code for large problems out of the serial path it is called from,
+// so that the serial path stays small enough to be inlined
+#if defined(_MSC_VER)
+#define NELDER_MEAD_NOINLINE __declspec(noinline)
+#else
+#define NELDER_MEAD_NOINLINE __attribute__((noinline))
+#endif
+
+
+// Compile-time policies used by BasicNelderMead. A policy set is a struct that
+// names one type for each customization point:
+//
+//     struct MyPolicies : NelderMeadDefaultPolicies {
+//         using Constraint = NelderMeadNoConstraint;
+//     };
+//     BasicNelderMead<MyPolicies> solver(2, myFunction);
+//
+// Policies that do nothing are empty inline functions, so a feature that is
+// not used costs nothing at run time. Hooks that receive the solver take it as
+// a template parameter and may use any of its public get methods.
+
+// The kinds of step taken by an iteration, as reported to instrumentation
+enum class NelderMeadStep {
+    Reflection,
+    Expansion,
+    OutsideContraction,
+    InsideContraction,
+    Shrink
+};
+
+
+// Ordering: finds the vertices with the smallest (vs), next smallest (vh) and
+// largest (vg) values. The indexes from the previous call are passed back in.
+
+struct NelderMeadScanOrdering {
+    static void order(const std::vector<double> & f, uint32_t size, uint32_t & vs, uint32_t & vh, uint32_t & vg)
+    {
+        vh = vs;
+        for (uint32_t j = 0; j <= size; j++) {
+            if (f[j] > f[vg]) {
+                vg = j;
+            }
+            if (f[j] < f[vs]) {
+                vs = j;
+            }
+        }
+        vh = vs;
+        for (uint32_t j = 0; j <= size; j++) {
+            if (f[j] > f[vh] && f[j] < f[vg]) {
+                vh = j;
+            }
+        }
+    }
+};
+
+
+// Centroid: computes the centroid of all vertices except vg. resize is called
+// once by the constructor, reset whenever every vertex may have changed and
+// replace just before the worst vertex is overwritten with a new point.
+
+// Sums all vertices on every iteration. Exact, but O(n^2) per iteration.
+struct NelderMeadRecomputedCentroid {
+    template <typename Solver>
+    void resize(const Solver &) {}
+
+    template <typename Solver>
+    void reset(const Solver &) {}
+
+    template <typename Solver>
+    void replace(const Solver &, const std::vector<double> &) {}
+
+    template <typename Solver>
+    void compute(const Solver & solver, std::vector<double> & vm)
+    {
+        const std::vector<std::vector<double>> & v = solver.getVertices();
+        uint32_t size = solver.getSize();
+        uint32_t vg = solver.getWorstIndex();
+
+        // Small problems sum each coordinate in a register
+        if (!solver.isParallelSize()) {
+            for (uint32_t j = 0; j < size; j++) {
+                double cent = 0.0;
+                for (uint32_t m = 0; m <= size; m++) {
+                    if (m != vg) {
+                        cent += v[m][j];
+                    }
+                }
+                vm[j] = cent / size;
+            }
+            return;
+        }
+
+        // Large ones are summed row by row so that each thread walks contiguous memory. The
+        // order of the additions for any one coordinate is the same as if the
+        // coordinates were summed one at a time.
+        solver.forRange(size, Solver::elementChunk, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t j = begin; j < end; j++) {
+                vm[j] = 0.0;
+            }
+            for (uint32_t m = 0; m <= size; m++) {
+                if (m != vg) {
+                    const double * row = v[m].data();
+                    for (uint32_t j = begin; j < end; j++) {
+                        vm[j] += row[j];
+                    }
+                }
+            }
+            for (uint32_t j = begin; j < end; j++) {
+                vm[j] = vm[j] / size;
+            }
+        });
+    }
+};
+
+// Keeps a running sum of all vertices and updates it as vertices are replaced,
+// making the centroid O(n) per iteration. Rounding in the running sum means
+// results differ slightly from NelderMeadRecomputedCentroid.
+struct NelderMeadRunningCentroid {
+    std::vector<double> sum;
+
+    template <typename Solver>
+    void resize(const Solver & solver) { sum.resize(solver.getSize()); }
+
+    template <typename Solver>
+    void reset(const Solver & solver)
+    {
+        const std::vector<std::vector<double>> & v = solver.getVertices();
+        uint32_t size = solver.getSize();
+
+        solver.forRange(size, Solver::elementChunk, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t j = begin; j < end; j++) {
+                sum[j] = 0.0;
+            }
+            for (uint32_t m = 0; m <= size; m++) {
+                const double * row = v[m].data();
+                for (uint32_t j = begin; j < end; j++) {
+                    sum[j] += row[j];
+                }
+            }
+        });
+    }
+
+    template <typename Solver>
+    void replace(const Solver & solver, const std::vector<double> & point)
+    {
+        const std::vector<double> & old = solver.getVertices()[solver.getWorstIndex()];
+
+        solver.forRange(solver.getSize(), Solver::elementChunk, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t j = begin; j < end; j++) {
+                sum[j] += point[j] - old[j];
+            }
+        });
+    }
+
+    template <typename Solver>
+    void compute(const Solver & solver, std::vector<double> & vm)
+    {
+        const std::vector<double> & worst = solver.getVertices()[solver.getWorstIndex()];
+        uint32_t size = solver.getSize();
+
+        solver.forRange(size, Solver::elementChunk, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t j = begin; j < end; j++) {
+                vm[j] = (sum[j] - worst[j]) / size;
+            }
+        });
+    }
+};
+
+
+// Convergence: decides after each iteration whether the search is complete.
+// resize is called once by the constructor.
+
+// Stops once the standard deviation of the values at the vertices falls below
+// the tolerance passed to exec.
+struct NelderMeadStdDevConvergence {
+    std::vector<double> partial;    // per block partial sums of reductions
+
+    template <typename Solver>
+    void resize(const Solver & solver)
+    {
+        partial.resize((solver.getSize() + Solver::elementChunk) / Solver::elementChunk);
+    }
+
+    template <typename Solver>
+    bool converged(const Solver & solver, double tolerance)
+    {
+        const std::vector<double> & f = solver.getValues();
+        uint32_t size = solver.getSize();
+        double fsum = 0.0;
+        double s = 0.0;
+
+        if (!solver.isParallelSize()) {
+            for (uint32_t j = 0; j <= size; j++) {
+                fsum += f[j];
+            }
+            double favg = fsum / (size + 1);
+            for (uint32_t j = 0; j <= size; j++) {
+                s += pow((f[j] - favg), 2.0) / (size);
+            }
+        }
+        else {
+            s = blockVariance(solver);
+        }
+
+        s = sqrt(s);
+        return s < tolerance;
+    }
+
+    // Large problems sum fixed blocks and then add the block totals in order,
+    // whether or not the blocks were computed on other threads.
+    template <typename Solver>
+    NELDER_MEAD_NOINLINE double blockVariance(const Solver & solver)
+    {
+        uint32_t size = solver.getSize();
+        double fsum = blockSum(solver, [](double fj) { return fj; });
+        double favg = fsum / (size + 1);
+        return blockSum(solver, [&](double fj) { return pow((fj - favg), 2.0) / (size); });
+    }
+
+    template <typename Solver, typename Term>
+    double blockSum(const Solver & solver, const Term & term)
+    {
+        const std::vector<double> & f = solver.getValues();
+        uint32_t count = solver.getSize() + 1;
+        uint32_t blocks = (uint32_t)partial.size();
+
+        solver.forBlocks(blocks, [&](uint32_t b) {
+            uint32_t end = (b + 1) * Solver::elementChunk < count ? (b + 1) * Solver::elementChunk : count;
+            double sum = 0.0;
+            for (uint32_t j = b * Solver::elementChunk; j < end; j++) {
+                sum += term(f[j]);
+            }
+            partial[b] = sum;
+        });
+
+        double total = 0.0;
+        for (uint32_t b = 0; b < blocks; b++) {
+            total += partial[b];
+        }
+        return total;
+    }
+};
+
+
+// Constraint: moves a point into the feasible region before it is evaluated.
+
+// Calls a run-time constraint function, if one was provided
+struct NelderMeadFunctionConstraint {
+    std::function<void(std::vector<double>&)> constrainFunc;
+
+    NelderMeadFunctionConstraint() {}
+    NelderMeadFunctionConstraint(std::nullptr_t) {}
+    template <typename Func, typename = typename std::enable_if<
+        !std::is_same<typename std::decay<Func>::type, NelderMeadFunctionConstraint>::value>::type>
+    NelderMeadFunctionConstraint(const Func & inFunc) : constrainFunc(inFunc) {}
+
+    void constrain(std::vector<double> & x)
+    {
+        if (constrainFunc) {
+            constrainFunc(x);
+        }
+    }
+};
+
+// Unconstrained problems
+struct NelderMeadNoConstraint {
+    NelderMeadNoConstraint() {}
+    NelderMeadNoConstraint(std::nullptr_t) {}
+
+    void constrain(std::vector<double> &) {}
+};
+
+
+// Callback: called at the end of every iteration. Returning false ends the
+// search as if it had converged.
+
+struct NelderMeadNoCallback {
+    template <typename Solver>
+    bool iteration(const Solver &) { return true; }
+};
+
+// Calls a run-time function with the iteration count and the current best
+// vertex and value after every iteration
+struct NelderMeadFunctionCallback {
+    std::function<bool(uint32_t, const std::vector<double>&, double)> callbackFunc;
+
+    NelderMeadFunctionCallback() {}
+    NelderMeadFunctionCallback(std::nullptr_t) {}
+    template <typename Func, typename = typename std::enable_if<
+        !std::is_same<typename std::decay<Func>::type, NelderMeadFunctionCallback>::value>::type>
+    NelderMeadFunctionCallback(const Func & inFunc) : callbackFunc(inFunc) {}
+
+    template <typename Solver>
+    bool iteration(const Solver & solver)
+    {
+        if (!callbackFunc) {
+            return true;
+        }
+        uint32_t vs = solver.getBestIndex();
+        return callbackFunc(solver.getIterationCount(), solver.getVertices()[vs], solver.getValues()[vs]);
+    }
+};
+
+
+// Instrumentation: told about every evaluation and every step taken.
+
+struct NelderMeadNoInstrumentation {
+    void start() {}
+    void evaluated(double) {}
+    void step(NelderMeadStep) {}
+};
+
+// Counts the steps taken by the last exec call
+struct NelderMeadStepCounter {
+    uint32_t evaluations = 0;
+    uint32_t steps[5] = { 0, 0, 0, 0, 0 };
+
+    void start()
+    {
+        evaluations = 0;
+        for (auto & count : steps) {
+            count = 0;
+        }
+    }
+    void evaluated(double) { evaluations++; }
+    void step(NelderMeadStep inStep) { steps[(int)inStep]++; }
+    uint32_t getStepCount(NelderMeadStep inStep) const { return steps[(int)inStep]; }
+};
+
+
+// The policies used by NelderMead. Derive from this and override some of the
+// types to customize a solver.
+struct NelderMeadDefaultPolicies {
+    using Ordering = NelderMeadScanOrdering;
+    using Centroid = NelderMeadRecomputedCentroid;
+    using Convergence = NelderMeadStdDevConvergence;
+    using Constraint = NelderMeadFunctionConstraint;
+    using Callback = NelderMeadNoCallback;
+    using Instrumentation = NelderMeadNoInstrumentation;
+};
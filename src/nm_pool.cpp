@@ -0,0 +1,103 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#include "nm_pool.h"
+
+
+NelderMeadThreadPool::NelderMeadThreadPool(uint32_t inThreadCount)
+{
+    threadCount = inThreadCount < 1 ? 1 : inThreadCount;
+
+    workers.reserve(threadCount - 1);
+    for (uint32_t i = 1; i < threadCount; i++) {
+        workers.emplace_back([this]() { doWorkerLoop(); });
+    }
+}
+
+NelderMeadThreadPool::~NelderMeadThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    startCond.notify_all();
+    for (auto & worker : workers) {
+        worker.join();
+    }
+}
+
+
+void NelderMeadThreadPool::doWork(const std::function<void(uint32_t)> & func, uint32_t chunks)
+{
+    uint32_t chunk;
+    while ((chunk = nextChunk.fetch_add(1)) < chunks) {
+        func(chunk);
+        remaining.fetch_sub(1);
+    }
+}
+
+void NelderMeadThreadPool::doWorkerLoop()
+{
+    uint64_t seen = 0;
+
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        startCond.wait(guard, [&]() { return stopping || generation != seen; });
+        if (stopping) {
+            return;
+        }
+        seen = generation;
+
+        // A worker that wakes up after the job has already been finished by
+        // the others must not touch it, the caller may have returned already.
+        if (remaining.load() == 0) {
+            continue;
+        }
+
+        busy++;
+        const std::function<void(uint32_t)> * func = job;
+        uint32_t chunks = jobChunks;
+        guard.unlock();
+
+        doWork(*func, chunks);
+
+        guard.lock();
+        if (--busy == 0 && remaining.load() == 0) {
+            doneCond.notify_all();
+        }
+    }
+}
+
+void NelderMeadThreadPool::run(uint32_t chunkCount, const std::function<void(uint32_t)> & func)
+{
+    if (chunkCount == 0) {
+        return;
+    }
+    if (workers.empty() || chunkCount == 1) {
+        for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+            func(chunk);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        job = &func;
+        jobChunks = chunkCount;
+        nextChunk.store(0);
+        remaining.store(chunkCount);
+        generation++;
+    }
+    startCond.notify_all();
+
+    doWork(func, chunkCount);
+
+    // wait for the chunks that were claimed by the workers
+    std::unique_lock<std::mutex> guard(lock);
+    doneCond.wait(guard, [&]() { return remaining.load() == 0 && busy == 0; });
+    job = nullptr;
+}
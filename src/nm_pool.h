@@ -0,0 +1,64 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#pragma once
+
+// system headers
+#include <stdint.h>
+
+// std library headers
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// A fixed set of worker threads used to split the vector kernels of a solver
+// iteration into chunks. The calling thread always takes part in the work, so
+// a pool with a thread count of N only starts N - 1 worker threads.
+class NelderMeadThreadPool
+{
+    public:
+        // Constructors and destructor
+
+        NelderMeadThreadPool(uint32_t inThreadCount);
+        ~NelderMeadThreadPool();
+
+        // public methods
+
+        // Calls func(chunk) exactly once for every chunk in [0, chunkCount) and
+        // returns once all of them have completed. Which thread runs which
+        // chunk is not defined, so func must not depend on it.
+        void run(uint32_t chunkCount, const std::function<void(uint32_t)> & func);
+        uint32_t getThreadCount() const { return threadCount; }
+
+
+    private:
+        uint32_t threadCount = 1;
+        std::vector<std::thread> workers;
+
+        // State of the job currently being run. Guarded by lock, except for
+        // the chunk counters which are claimed without it.
+
+        std::mutex lock;
+        std::condition_variable startCond;
+        std::condition_variable doneCond;
+        const std::function<void(uint32_t)> * job = nullptr;
+        uint32_t jobChunks = 0;
+        uint64_t generation = 0;
+        uint32_t busy = 0;          // workers that joined the current job
+        bool stopping = false;
+        std::atomic<uint32_t> nextChunk{ 0 };
+        std::atomic<uint32_t> remaining{ 0 };
+
+        // private methods
+
+        void doWork(const std::function<void(uint32_t)> & func, uint32_t chunks);
+        void doWorkerLoop();
+};
@@ -0,0 +1,138 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#include "nm_telemetry.h"
+
+#include <math.h>
+
+
+uint32_t NelderMeadConvergenceRecord::getCheckpoint(uint32_t i)
+{
+    // every count up to 16, then 2^((i + 1) / 4) rounded down, which from
+    // there on always moves by at least three
+    if (i < 16) {
+        return i + 1;
+    }
+    return (uint32_t)pow(2.0, (i + 1) / 4.0);
+}
+
+
+static const uint32_t columns = NelderMeadConvergenceRecord::capacity + 1;
+
+NelderMeadConvergenceProfile::NelderMeadConvergenceProfile()
+    : NelderMeadConvergenceProfile({ 1.0e-1, 1.0e-2, 1.0e-3, 1.0e-4, 1.0e-5, 1.0e-6, 1.0e-7, 1.0e-8 })
+{
+}
+
+NelderMeadConvergenceProfile::NelderMeadConvergenceProfile(const std::vector<double> & inAccuracies)
+{
+    accuracies = inAccuracies;
+    counts.assign(accuracies.size() * columns, 0);
+}
+
+NelderMeadConvergenceProfile::~NelderMeadConvergenceProfile()
+{
+}
+
+
+void NelderMeadConvergenceProfile::add(const NelderMeadConvergenceRecord & record)
+{
+    doAdd(record, record.last);
+}
+
+void NelderMeadConvergenceProfile::add(const NelderMeadConvergenceRecord & record, double reference)
+{
+    doAdd(record, reference);
+}
+
+void NelderMeadConvergenceProfile::doAdd(const NelderMeadConvergenceRecord & record, double reference)
+{
+    runCount++;
+    double range = record.first - reference;
+    if (record.evalCount == 0 || !(fabs(range) < HUGE_VAL)) {
+        return;
+    }
+
+    for (size_t a = 0; a < accuracies.size(); a++) {
+        double target = reference + accuracies[a] * range;
+        uint64_t * row = &counts[a * columns];
+
+        // first checkpoint at which the best value was within the accuracy.
+        // Samples are best so far, so they only ever go down.
+        uint32_t i = 0;
+        while (i < record.sampleCount && record.best[i] > target) {
+            i++;
+        }
+        if (i < record.sampleCount) {
+            row[i]++;
+        }
+        else if (record.last <= target) {
+            // reached between the last sample and the end of the search
+            row[record.sampleCount < NelderMeadConvergenceRecord::capacity ? record.sampleCount : columns - 1]++;
+        }
+    }
+}
+
+void NelderMeadConvergenceProfile::merge(const NelderMeadConvergenceProfile & other)
+{
+    for (size_t i = 0; i < counts.size() && i < other.counts.size(); i++) {
+        counts[i] += other.counts[i];
+    }
+    runCount += other.runCount;
+}
+
+void NelderMeadConvergenceProfile::clear()
+{
+    counts.assign(counts.size(), 0);
+    runCount = 0;
+}
+
+uint64_t NelderMeadConvergenceProfile::getReachedCount(uint32_t accuracy) const
+{
+    uint64_t reached = 0;
+    for (uint32_t i = 0; i < columns; i++) {
+        reached += counts[accuracy * columns + i];
+    }
+    return reached;
+}
+
+uint32_t NelderMeadConvergenceProfile::getPercentile(uint32_t accuracy, double fraction) const
+{
+    // the run at this rank, counting the runs that never got there as the slowest
+    uint64_t rank = (uint64_t)ceil(fraction * runCount);
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < columns; i++) {
+        seen += counts[accuracy * columns + i];
+        if (seen >= rank) {
+            // runs past the last checkpoint are only known to have needed more
+            return i < NelderMeadConvergenceRecord::capacity ? NelderMeadConvergenceRecord::getCheckpoint(i) : 0;
+        }
+    }
+    return 0;
+}
+
+void NelderMeadConvergenceProfile::writeCsv(std::ostream & out) const
+{
+    static const double fractions[] = { 0.5, 0.9, 0.99 };
+
+    out << "accuracy,runs,reached,p50,p90,p99\n";
+    for (uint32_t a = 0; a < (uint32_t)accuracies.size(); a++) {
+        out << accuracies[a] << ',' << runCount << ',' << getReachedCount(a);
+        for (double fraction : fractions) {
+            out << ',';
+            uint32_t evals = getPercentile(a, fraction);
+            if (evals > 0) {
+                out << evals;
+            }
+        }
+        out << '\n';
+    }
+}
@@ -0,0 +1,146 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#pragma once
+
+// system headers
+#include <math.h>
+#include <stdint.h>
+
+// std library headers
+#include <ostream>
+#include <vector>
+
+// project headers
+#include "nm_policies.h"
+
+
+// The best value found so far by a search, sampled at log spaced evaluation
+// counts. Sample i is taken after getCheckpoint(i) evaluations: every count up
+// to 16, then four samples per doubling. NaN values are counted as evaluations
+// but never become the best value, so until a search has found a number its
+// samples are HUGE_VAL. The record has a fixed size and the recorder never
+// allocates, so it can stay switched on in production.
+struct NelderMeadConvergenceRecord {
+    static const uint32_t capacity = 96;    // covers about 16 million evaluations
+
+    uint32_t sampleCount = 0;
+    uint32_t evalCount = 0;     // of the whole search, which may end between samples
+    double first = HUGE_VAL;    // first value that was not NaN
+    double last = HUGE_VAL;     // best value at the end of the search
+    double best[capacity];
+
+    static uint32_t getCheckpoint(uint32_t i);
+};
+
+
+// Instrumentation policy that fills a NelderMeadConvergenceRecord during each
+// exec call:
+//
+//     struct RecordedPolicies : NelderMeadDefaultPolicies {
+//         using Instrumentation = NelderMeadConvergenceRecorder;
+//     };
+//     BasicNelderMead<RecordedPolicies> solver(size, evalFunc);
+//     solver.exec(start, 1.0e-8, 1.0);
+//     profile.add(solver.getInstrumentation().getRecord());
+class NelderMeadConvergenceRecorder
+{
+    public:
+        void start()
+        {
+            record.sampleCount = 0;
+            record.evalCount = 0;
+            record.first = HUGE_VAL;
+            record.last = HUGE_VAL;
+            seenNumber = false;
+            nextCheckpoint = NelderMeadConvergenceRecord::getCheckpoint(0);
+        }
+
+        void evaluated(double value)
+        {
+            record.evalCount++;
+            if (value == value) {
+                if (!seenNumber) {
+                    record.first = value;
+                    seenNumber = true;
+                }
+                if (value < record.last) {
+                    record.last = value;
+                }
+            }
+            if (record.evalCount >= nextCheckpoint && record.sampleCount < NelderMeadConvergenceRecord::capacity) {
+                record.best[record.sampleCount++] = record.last;
+                nextCheckpoint = NelderMeadConvergenceRecord::getCheckpoint(record.sampleCount);
+            }
+        }
+
+        void step(NelderMeadStep) {}
+
+        const NelderMeadConvergenceRecord & getRecord() const { return record; }
+
+
+    private:
+        NelderMeadConvergenceRecord record;
+        uint32_t nextCheckpoint = 1;
+        bool seenNumber = false;
+};
+
+
+// Collects convergence records from many searches into a histogram, per relative
+// accuracy, of the number of evaluations each search needed to reach it. The
+// relative accuracy of a value is
+//
+//     (value - reference) / (first - reference)
+//
+// where reference is the optimum, if known, or else the best value the search
+// ended with. A search whose first number was infinite, or that found no number
+// at all, has no scale to measure accuracy by and reaches none. Counts are kept
+// on the checkpoint grid of the records, so a profile has a fixed size however
+// many searches are added, and profiles filled on different threads are
+// combined with merge. A profile is not itself thread safe.
+class NelderMeadConvergenceProfile
+{
+    public:
+        // Constructors and destructor
+
+        // The default accuracies are 1e-1 down to 1e-8
+        NelderMeadConvergenceProfile();
+        NelderMeadConvergenceProfile(const std::vector<double> & inAccuracies);
+        ~NelderMeadConvergenceProfile();
+
+        // public methods
+
+        void add(const NelderMeadConvergenceRecord & record);
+        void add(const NelderMeadConvergenceRecord & record, double reference);
+
+        // Profiles must have been constructed with the same accuracies
+        void merge(const NelderMeadConvergenceProfile & other);
+        void clear();
+
+        const std::vector<double> & getAccuracies() const { return accuracies; }
+        uint64_t getRunCount() const { return runCount; }
+        uint64_t getReachedCount(uint32_t accuracy) const;
+
+        // Evaluations by which the given fraction of all runs had reached the
+        // accuracy, rounded up to a checkpoint. 0 if too few runs reached it.
+        uint32_t getPercentile(uint32_t accuracy, double fraction) const;
+
+        // One row per accuracy: accuracy,runs,reached,p50,p90,p99. Percentiles
+        // that were not reached are left empty.
+        void writeCsv(std::ostream & out) const;
+
+
+    private:
+        std::vector<double> accuracies;
+        std::vector<uint64_t> counts;   // accuracies rows of capacity + 1 checkpoints, the last for
+                                        // runs that ended after the final checkpoint
+        uint64_t runCount = 0;
+
+        // private methods
+
+        void doAdd(const NelderMeadConvergenceRecord & record, double reference);
+};
@@ -0,0 +1,480 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#include "nm_worstcase.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+
+// Ranges the coefficients are drawn from when they are searched
+static const double reflectionRange[2] = { 0.5, 2.0 };
+static const double contractionRange[2] = { 0.2, 0.8 };
+static const double expansionRange[2] = { 1.5, 4.0 };
+
+static const char * strategyNames[] = { "greedy-min", "greedy-exp", "repeated", "inside-only" };
+static const int strategyCount = sizeof(strategyNames) / sizeof(strategyNames[0]);
+
+
+NelderMeadWorstCaseSearch::NelderMeadWorstCaseSearch(uint32_t inThreadCount)
+    : pool(inThreadCount)
+{
+}
+
+NelderMeadWorstCaseSearch::~NelderMeadWorstCaseSearch()
+{
+}
+
+
+uint32_t NelderMeadWorstCaseSearch::addFamily(const NelderMeadObjectiveFamily & family)
+{
+    // fixture lines are split at whitespace, so a name must not contain any
+    for (char c : family.name) {
+        if (isspace((unsigned char)c)) {
+            throw std::invalid_argument("NelderMeadWorstCaseSearch: family names must not contain whitespace");
+        }
+    }
+    if (family.size == 0) {
+        throw std::invalid_argument("NelderMeadWorstCaseSearch: a family needs at least one variable");
+    }
+    if (!family.evalFunc) {
+        throw std::invalid_argument("NelderMeadWorstCaseSearch: a family needs an evaluation function");
+    }
+    if (family.lowerParams.empty() || family.lowerParams.size() != family.upperParams.size()) {
+        throw std::invalid_argument("NelderMeadWorstCaseSearch: a family needs as many upper as lower parameter bounds, and at least one");
+    }
+    for (size_t i = 0; i < family.lowerParams.size(); i++) {
+        // also false for NaN
+        if (!(family.lowerParams[i] <= family.upperParams[i])) {
+            throw std::invalid_argument("NelderMeadWorstCaseSearch: a parameter range is empty");
+        }
+    }
+    families.push_back(family);
+    return (uint32_t)families.size() - 1;
+}
+
+std::vector<NelderMeadObjectiveFamily> NelderMeadWorstCaseSearch::getStandardFamilies(uint32_t size)
+{
+    std::vector<NelderMeadObjectiveFamily> standard(4);
+
+    // axis aligned ellipsoid with a condition number of 10^p
+    standard[0].name = "ellipsoid";
+    standard[0].lowerParams = { 0.0 };
+    standard[0].upperParams = { 8.0 };
+    standard[0].evalFunc = [](const std::vector<double> & p, const std::vector<double> & x) {
+        double sum = 0.0;
+        double last = x.size() > 1 ? (double)(x.size() - 1) : 1.0;
+        for (size_t i = 0; i < x.size(); i++) {
+            sum += pow(10.0, p[0] * i / last) * x[i] * x[i];
+        }
+        return sum;
+    };
+
+    // Rosenbrock with the curvature of its valley as parameter
+    standard[1].name = "rosenbrock";
+    standard[1].lowerParams = { 1.0 };
+    standard[1].upperParams = { 1000.0 };
+    standard[1].evalFunc = [](const std::vector<double> & p, const std::vector<double> & x) {
+        double sum = 0.0;
+        for (size_t i = 0; i + 1 < x.size(); i++) {
+            double a = x[i + 1] - x[i] * x[i];
+            double b = 1.0 - x[i];
+            sum += p[0] * a * a + b * b;
+        }
+        return sum;
+    };
+
+    // valley along the diagonal whose floor rises with a slope of 10^p
+    standard[2].name = "valley";
+    standard[2].lowerParams = { -8.0 };
+    standard[2].upperParams = { 0.0 };
+    standard[2].evalFunc = [](const std::vector<double> & p, const std::vector<double> & x) {
+        double sum = pow(10.0, p[0]) * x[0] * x[0];
+        for (size_t i = 1; i < x.size(); i++) {
+            double d = x[i] - x[0];
+            sum += d * d;
+        }
+        return sum;
+    };
+
+    // sum of |x - 1|^p, with a kink at the minimum
+    standard[3].name = "power";
+    standard[3].lowerParams = { 0.25 };
+    standard[3].upperParams = { 2.0 };
+    standard[3].evalFunc = [](const std::vector<double> & p, const std::vector<double> & x) {
+        double sum = 0.0;
+        for (double xi : x) {
+            sum += pow(fabs(xi - 1.0), p[0]);
+        }
+        return sum;
+    };
+
+    for (auto & family : standard) {
+        family.size = size;
+    }
+    return standard;
+}
+
+
+bool NelderMeadWorstCaseSearch::isFailing(const NelderMeadWorstCase & worstCase) const
+{
+    return worstCase.hitMaxIterations || (configFailEvalCount > 0 && worstCase.evalCount >= configFailEvalCount);
+}
+
+double NelderMeadWorstCaseSearch::doCost(const NelderMeadWorstCase & worstCase) const
+{
+    return configCost == NelderMeadWorstCaseCost::Time ? worstCase.seconds : (double)worstCase.evalCount;
+}
+
+void NelderMeadWorstCaseSearch::replay(NelderMeadWorstCase & worstCase) const
+{
+    const NelderMeadObjectiveFamily & family = families[worstCase.family];
+    const std::vector<double> & params = worstCase.params;
+
+    BasicNelderMead<StepPolicies> solver(family.size, [&](const std::vector<double> & x) {
+        return family.evalFunc(params, x);
+    });
+    solver.setMaxIterations(configMaxIterations);
+    solver.setReflectionCoefficient(worstCase.reflection);
+    solver.setContractionCoefficient(worstCase.contraction);
+    solver.setExpansionCoefficient(worstCase.expansion);
+    solver.setStrategy(worstCase.strategy);
+
+    auto begin = std::chrono::steady_clock::now();
+    solver.exec(worstCase.start, configTolerance, worstCase.scale);
+    auto end = std::chrono::steady_clock::now();
+
+    const NelderMeadResults & results = solver.getLastExecResults();
+    worstCase.evalCount = results.evalCount;
+    worstCase.iterationCount = results.iterationCount;
+    worstCase.seconds = std::chrono::duration<double>(end - begin).count();
+    worstCase.hitMaxIterations = results.iterationCount > configMaxIterations;
+    for (int s = 0; s < 5; s++) {
+        worstCase.steps[s] = solver.getInstrumentation().getStepCount((NelderMeadStep)s);
+    }
+}
+
+void NelderMeadWorstCaseSearch::doRandomCase(NelderMeadWorstCase & worstCase, std::mt19937_64 & random) const
+{
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    worstCase.family = (uint32_t)(random() % families.size());
+    const NelderMeadObjectiveFamily & family = families[worstCase.family];
+
+    worstCase.params.resize(family.lowerParams.size());
+    for (size_t i = 0; i < worstCase.params.size(); i++) {
+        worstCase.params[i] = family.lowerParams[i] + unit(random) * (family.upperParams[i] - family.lowerParams[i]);
+    }
+    worstCase.start.resize(family.size);
+    for (auto & x : worstCase.start) {
+        x = configStartLower + unit(random) * (configStartUpper - configStartLower);
+    }
+    worstCase.scale = configScaleLower * pow(configScaleUpper / configScaleLower, unit(random));
+
+    if (configSearchCoefficients) {
+        worstCase.reflection = reflectionRange[0] + unit(random) * (reflectionRange[1] - reflectionRange[0]);
+        worstCase.contraction = contractionRange[0] + unit(random) * (contractionRange[1] - contractionRange[0]);
+        worstCase.expansion = expansionRange[0] + unit(random) * (expansionRange[1] - expansionRange[0]);
+        worstCase.strategy = (NelderMeadStrategy)(random() % 4);
+    }
+}
+
+void NelderMeadWorstCaseSearch::doMutate(NelderMeadWorstCase & worstCase, std::mt19937_64 & random) const
+{
+    std::normal_distribution<double> normal(0.0, 1.0);
+    auto clamp = [](double x, double lower, double upper) { return x < lower ? lower : (x > upper ? upper : x); };
+
+    const NelderMeadObjectiveFamily & family = families[worstCase.family];
+    for (size_t i = 0; i < worstCase.params.size(); i++) {
+        double range = family.upperParams[i] - family.lowerParams[i];
+        worstCase.params[i] = clamp(worstCase.params[i] + 0.1 * range * normal(random), family.lowerParams[i], family.upperParams[i]);
+    }
+    for (auto & x : worstCase.start) {
+        x += 0.1 * (configStartUpper - configStartLower) * normal(random);
+    }
+    worstCase.scale = clamp(worstCase.scale * exp(0.5 * normal(random)), configScaleLower, configScaleUpper);
+
+    if (configSearchCoefficients) {
+        worstCase.reflection = clamp(worstCase.reflection + 0.1 * normal(random), reflectionRange[0], reflectionRange[1]);
+        worstCase.contraction = clamp(worstCase.contraction + 0.05 * normal(random), contractionRange[0], contractionRange[1]);
+        worstCase.expansion = clamp(worstCase.expansion + 0.2 * normal(random), expansionRange[0], expansionRange[1]);
+        if (random() % 10 == 0) {
+            worstCase.strategy = (NelderMeadStrategy)(random() % 4);
+        }
+    }
+}
+
+void NelderMeadWorstCaseSearch::doRunAll(std::vector<NelderMeadWorstCase> & cases)
+{
+    pool.run((uint32_t)cases.size(), [&](uint32_t i) {
+        replay(cases[i]);
+    });
+}
+
+void NelderMeadWorstCaseSearch::doKeepWorst(std::vector<NelderMeadWorstCase> & worst, std::vector<NelderMeadWorstCase> & candidates) const
+{
+    // the cases already held come first, so that ties keep them
+    for (auto & candidate : candidates) {
+        worst.push_back(std::move(candidate));
+    }
+    std::stable_sort(worst.begin(), worst.end(), [this](const NelderMeadWorstCase & a, const NelderMeadWorstCase & b) {
+        return doCost(a) > doCost(b);
+    });
+    if (worst.size() > configReportSize) {
+        worst.resize(configReportSize);
+    }
+}
+
+void NelderMeadWorstCaseSearch::doMinimize(NelderMeadWorstCase & worstCase) const
+{
+    // Each attempt moves one value to something simpler and is kept if the
+    // case still fails. Repeated until a whole pass changes nothing.
+    auto attempt = [&](const std::function<bool(NelderMeadWorstCase&)> & simplify) {
+        NelderMeadWorstCase trial = worstCase;
+        if (!simplify(trial)) {
+            return false;
+        }
+        replay(trial);
+        if (!isFailing(trial)) {
+            return false;
+        }
+        worstCase = trial;
+        return true;
+    };
+    auto moveTo = [](double & x, double simpler) {
+        if (x == simpler) {
+            return false;
+        }
+        x = simpler;
+        return true;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        changed |= attempt([](NelderMeadWorstCase & c) {
+            if (c.strategy == NelderMeadStrategy::GreedyMinimization) {
+                return false;
+            }
+            c.strategy = NelderMeadStrategy::GreedyMinimization;
+            return true;
+        });
+        changed |= attempt([&](NelderMeadWorstCase & c) { return moveTo(c.reflection, 1.0); });
+        changed |= attempt([&](NelderMeadWorstCase & c) { return moveTo(c.contraction, 0.5); });
+        changed |= attempt([&](NelderMeadWorstCase & c) { return moveTo(c.expansion, 2.0); });
+        // the simplest value first, then a rounded one
+        changed |= attempt([&](NelderMeadWorstCase & c) { return moveTo(c.scale, 1.0); })
+            || attempt([&](NelderMeadWorstCase & c) {
+                double unit = pow(10.0, floor(log10(c.scale)));
+                return moveTo(c.scale, round(c.scale / unit) * unit);
+            });
+        for (size_t j = 0; j < worstCase.start.size(); j++) {
+            changed |= attempt([&](NelderMeadWorstCase & c) { return moveTo(c.start[j], 0.0); })
+                || attempt([&](NelderMeadWorstCase & c) { return moveTo(c.start[j], round(c.start[j] * 10.0) / 10.0); });
+        }
+        for (size_t i = 0; i < worstCase.params.size(); i++) {
+            changed |= attempt([&](NelderMeadWorstCase & c) { return moveTo(c.params[i], round(c.params[i] * 10.0) / 10.0); });
+        }
+    }
+}
+
+void NelderMeadWorstCaseSearch::exec()
+{
+    lastExecResults.clear();
+    if (families.empty()) {
+        return;
+    }
+
+    // Every case draws from its own generator, seeded by its position in the
+    // search, so the cases do not depend on which thread runs them
+    auto generator = [this](uint32_t round, uint32_t index) {
+        std::seed_seq seed{ (uint32_t)configSeed, (uint32_t)(configSeed >> 32), round, index };
+        return std::mt19937_64(seed);
+    };
+
+    std::vector<NelderMeadWorstCase> worst;
+    std::vector<NelderMeadWorstCase> candidates(configSampleCount);
+    for (uint32_t i = 0; i < configSampleCount; i++) {
+        std::mt19937_64 random = generator(0, i);
+        doRandomCase(candidates[i], random);
+    }
+    doRunAll(candidates);
+    doKeepWorst(worst, candidates);
+
+    for (uint32_t round = 1; round <= configRoundCount; round++) {
+        candidates.clear();
+        for (const auto & parent : worst) {
+            for (uint32_t m = 0; m < configMutationCount; m++) {
+                candidates.push_back(parent);
+                std::mt19937_64 random = generator(round, (uint32_t)candidates.size());
+                doMutate(candidates.back(), random);
+            }
+        }
+        doRunAll(candidates);
+        doKeepWorst(worst, candidates);
+    }
+
+    pool.run((uint32_t)worst.size(), [&](uint32_t i) {
+        if (isFailing(worst[i])) {
+            doMinimize(worst[i]);
+        }
+    });
+
+    // minimizing can change the costs
+    std::stable_sort(worst.begin(), worst.end(), [this](const NelderMeadWorstCase & a, const NelderMeadWorstCase & b) {
+        return doCost(a) > doCost(b);
+    });
+    lastExecResults = worst;
+}
+
+
+void NelderMeadWorstCaseSearch::writeReport(std::ostream & out) const
+{
+    char line[256];
+
+    snprintf(line, sizeof(line), "%4s  %-12s %8s %8s %10s %5s %8s %8s %8s %8s %8s\n",
+        "rank", "family", "evals", "iters", "seconds", "fail", "reflect", "expand", "outside", "inside", "shrink");
+    out << line;
+
+    for (size_t r = 0; r < lastExecResults.size(); r++) {
+        const NelderMeadWorstCase & c = lastExecResults[r];
+        snprintf(line, sizeof(line), "%4u  %-12s %8u %8u %10.6f %5s %8u %8u %8u %8u %8u\n",
+            (uint32_t)r + 1, families[c.family].name.c_str(), c.evalCount, c.iterationCount, c.seconds,
+            isFailing(c) ? "yes" : "no",
+            c.steps[(int)NelderMeadStep::Reflection], c.steps[(int)NelderMeadStep::Expansion],
+            c.steps[(int)NelderMeadStep::OutsideContraction], c.steps[(int)NelderMeadStep::InsideContraction],
+            c.steps[(int)NelderMeadStep::Shrink]);
+        out << line;
+
+        snprintf(line, sizeof(line), "      scale %.3g  reflection %.3g  contraction %.3g  expansion %.3g  %s",
+            c.scale, c.reflection, c.contraction, c.expansion, strategyNames[(int)c.strategy]);
+        out << line;
+        for (double p : c.params) {
+            snprintf(line, sizeof(line), "  param %.4g", p);
+            out << line;
+        }
+        out << '\n';
+    }
+}
+
+void NelderMeadWorstCaseSearch::writeFixtures(std::ostream & out) const
+{
+    char number[32];
+    auto list = [&](const std::vector<double> & values) {
+        std::string text;
+        for (size_t i = 0; i < values.size(); i++) {
+            snprintf(number, sizeof(number), "%s%.17g", i ? "," : "", values[i]);
+            text += number;
+        }
+        return text;
+    };
+    auto exact = [&](double value) {
+        snprintf(number, sizeof(number), "%.17g", value);
+        return std::string(number);
+    };
+
+    for (const auto & c : lastExecResults) {
+        if (!isFailing(c)) {
+            continue;
+        }
+        const NelderMeadObjectiveFamily & family = families[c.family];
+        out << "family=" << family.name << " size=" << family.size
+            << " strategy=" << (int)c.strategy
+            << " scale=" << exact(c.scale)
+            << " reflection=" << exact(c.reflection)
+            << " contraction=" << exact(c.contraction)
+            << " expansion=" << exact(c.expansion)
+            << " params=" << list(c.params)
+            << " start=" << list(c.start)
+            << " evals=" << c.evalCount << '\n';
+    }
+}
+
+std::vector<NelderMeadWorstCase> NelderMeadWorstCaseSearch::readFixtures(std::istream & in) const
+{
+    std::vector<NelderMeadWorstCase> cases;
+    auto list = [](const std::string & text) {
+        std::vector<double> values;
+        std::istringstream items(text);
+        std::string item;
+        while (std::getline(items, item, ',')) {
+            values.push_back(strtod(item.c_str(), nullptr));
+        }
+        return values;
+    };
+
+    std::string line;
+    while (std::getline(in, line)) {
+        NelderMeadWorstCase c;
+        std::string name;
+        uint32_t size = 0;
+        bool valid = true;
+
+        std::istringstream fields(line);
+        std::string field;
+        while (fields >> field) {
+            size_t equals = field.find('=');
+            if (equals == std::string::npos) {
+                continue;
+            }
+            std::string key = field.substr(0, equals);
+            std::string value = field.substr(equals + 1);
+
+            if (key == "family") {
+                name = value;
+            }
+            else if (key == "size") {
+                size = (uint32_t)strtoul(value.c_str(), nullptr, 10);
+            }
+            else if (key == "strategy") {
+                char * end;
+                long strategy = strtol(value.c_str(), &end, 10);
+                valid = valid && *end == 0 && end != value.c_str() && strategy >= 0 && strategy < strategyCount;
+                c.strategy = (NelderMeadStrategy)(valid ? strategy : 0);
+            }
+            else if (key == "scale") {
+                c.scale = strtod(value.c_str(), nullptr);
+            }
+            else if (key == "reflection") {
+                c.reflection = strtod(value.c_str(), nullptr);
+            }
+            else if (key == "contraction") {
+                c.contraction = strtod(value.c_str(), nullptr);
+            }
+            else if (key == "expansion") {
+                c.expansion = strtod(value.c_str(), nullptr);
+            }
+            else if (key == "params") {
+                c.params = list(value);
+            }
+            else if (key == "start") {
+                c.start = list(value);
+            }
+            else if (key == "evals") {
+                c.evalCount = (uint32_t)strtoul(value.c_str(), nullptr, 10);
+            }
+        }
+
+        for (uint32_t f = 0; valid && f < (uint32_t)families.size(); f++) {
+            if (families[f].name == name && families[f].size == size
+                && c.start.size() == size && c.params.size() == families[f].lowerParams.size()) {
+                c.family = f;
+                cases.push_back(c);
+                break;
+            }
+        }
+    }
+    return cases;
+}
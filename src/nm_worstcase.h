@@ -0,0 +1,164 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+#pragma once
+
+// system headers
+#include <stdint.h>
+
+// std library headers
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// project headers
+#include "nm.h"
+
+
+// A family of objectives of a fixed number of variables, shaped by parameters
+// that each lie in a range. evalFunc is called with the parameters and a point.
+struct NelderMeadObjectiveFamily {
+    std::string name;
+    uint32_t size = 0;
+    std::vector<double> lowerParams;
+    std::vector<double> upperParams;
+    std::function<double(const std::vector<double>& params, const std::vector<double>& x)> evalFunc;
+};
+
+// What the worst-case search tries to make as large as possible
+enum class NelderMeadWorstCaseCost {
+    Evaluations,    // evaluations of one search; repeatable from run to run
+    Time            // wall clock time of one search
+};
+
+// One configuration of a search, and what running it cost
+struct NelderMeadWorstCase {
+    // configuration
+
+    uint32_t family = 0;        // index of the family in the harness
+    std::vector<double> params;
+    std::vector<double> start;
+    double scale = 1.0;
+    double reflection = 1.0;
+    double contraction = 0.5;
+    double expansion = 2.0;
+    NelderMeadStrategy strategy = NelderMeadStrategy::GreedyMinimization;
+
+    // outcome
+
+    uint32_t evalCount = 0;
+    uint32_t iterationCount = 0;
+    double seconds = 0.0;
+    bool hitMaxIterations = false;
+    uint32_t steps[5] = { 0, 0, 0, 0, 0 };     // by NelderMeadStep
+};
+
+
+// Searches for the configurations that make a solver work hardest. Starting from
+// random start points, scales, coefficients, strategies and family parameters,
+// the costliest cases found so far are repeatedly mutated and kept when they get
+// worse. Cases are run in parallel on a thread pool. With the Evaluations cost
+// the outcome depends only on the seed, not on the number of threads.
+//
+// Cases that hit the iteration limit, or that use at least the failing
+// evaluation count, are failing cases. Before they are reported they are
+// minimized: coefficients, strategy, scale, start coordinates and parameters are
+// each moved to a simpler value for as long as the case keeps failing. Failing
+// cases can be written as fixtures, read back and replayed by a benchmark suite.
+class NelderMeadWorstCaseSearch
+{
+    public:
+        // Constructors and destructor
+
+        NelderMeadWorstCaseSearch(uint32_t inThreadCount);
+        ~NelderMeadWorstCaseSearch();
+
+        // public methods
+
+        // Adds a family and returns its index. Names are written to fixtures, so
+        // one that contains whitespace throws std::invalid_argument, as does a
+        // family with no variables, no evaluation function, no parameters,
+        // lower and upper bounds of different lengths or a lower bound above
+        // its upper bound. getStandardFamilies returns an ill conditioned
+        // ellipsoid, Rosenbrock with a variable curvature, a narrow diagonal
+        // valley and a nonsmooth power of |x|.
+        uint32_t addFamily(const NelderMeadObjectiveFamily & family);
+        static std::vector<NelderMeadObjectiveFamily> getStandardFamilies(uint32_t size);
+
+        void exec();
+
+        // The worst cases found, costliest first, at most the report size of them
+        const std::vector<NelderMeadWorstCase> & getLastExecResults() const { return lastExecResults; }
+        bool isFailing(const NelderMeadWorstCase & worstCase) const;
+
+        // Runs a case, filling in its outcome
+        void replay(NelderMeadWorstCase & worstCase) const;
+
+        // Ranked table of the worst cases with their step breakdown
+        void writeReport(std::ostream & out) const;
+
+        // Failing cases, one per line, with every number written exactly. Lines
+        // refer to families by name; readFixtures skips those it cannot match,
+        // and those whose strategy is not a NelderMeadStrategy. The cases it
+        // returns hold the evaluation count they were written with, so a replay
+        // can be checked against it. Fixtures are only repeatable under the
+        // iteration limit and tolerance they were found with.
+        void writeFixtures(std::ostream & out) const;
+        std::vector<NelderMeadWorstCase> readFixtures(std::istream & in) const;
+
+        void setCost(NelderMeadWorstCaseCost inValue) { configCost = inValue; }
+        void setSeed(uint64_t inValue) { configSeed = inValue; }
+        void setSampleCount(uint32_t inValue) { configSampleCount = inValue; }
+        void setRoundCount(uint32_t inValue) { configRoundCount = inValue; }
+        void setMutationCount(uint32_t inValue) { configMutationCount = inValue; }
+        void setReportSize(uint32_t inValue) { configReportSize = inValue < 1 ? 1 : inValue; }
+        void setMaxIterations(uint32_t inValue) { configMaxIterations = inValue; }
+        void setTolerance(double inValue) { configTolerance = inValue; }
+        void setFailEvalCount(uint32_t inValue) { configFailEvalCount = inValue; }
+        void setStartRange(double inLower, double inUpper) { configStartLower = inLower; configStartUpper = inUpper; }
+        void setScaleRange(double inLower, double inUpper) { configScaleLower = inLower; configScaleUpper = inUpper; }
+        void setSearchCoefficients(bool inValue) { configSearchCoefficients = inValue; }
+
+
+    private:
+        // Configuration values that can be modified by the user prior to an exec call
+
+        NelderMeadWorstCaseCost configCost = NelderMeadWorstCaseCost::Evaluations;
+        uint64_t configSeed = 1;
+        uint32_t configSampleCount = 256;       // random cases to start from
+        uint32_t configRoundCount = 8;          // rounds of mutation
+        uint32_t configMutationCount = 8;       // mutations of each reported case per round
+        uint32_t configReportSize = 16;
+        uint32_t configMaxIterations = 1000;
+        double configTolerance = 1.0e-8;
+        uint32_t configFailEvalCount = 0;       // 0 fails only cases that hit the iteration limit
+        double configStartLower = -2.0;
+        double configStartUpper = 2.0;
+        double configScaleLower = 1.0e-3;
+        double configScaleUpper = 10.0;
+        bool configSearchCoefficients = true;
+
+        struct StepPolicies : NelderMeadDefaultPolicies {
+            using Instrumentation = NelderMeadStepCounter;
+        };
+
+        NelderMeadThreadPool pool;
+        std::vector<NelderMeadObjectiveFamily> families;
+        std::vector<NelderMeadWorstCase> lastExecResults;
+
+        // private methods
+
+        double doCost(const NelderMeadWorstCase & worstCase) const;
+        void doRandomCase(NelderMeadWorstCase & worstCase, std::mt19937_64 & random) const;
+        void doMutate(NelderMeadWorstCase & worstCase, std::mt19937_64 & random) const;
+        void doRunAll(std::vector<NelderMeadWorstCase> & cases);
+        void doKeepWorst(std::vector<NelderMeadWorstCase> & worst, std::vector<NelderMeadWorstCase> & candidates) const;
+        void doMinimize(NelderMeadWorstCase & worstCase) const;
+};
@@ -0,0 +1,205 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Checks NelderMeadBatch:
+//
+// - in every order and for 1 and 4 threads, each problem of a batch gives the
+//   same results, bit for bit, as running it on its own with exec. The batch
+//   mixes sizes, locality keys and constrained problems, and runs twice so
+//   that reused solvers are covered.
+// - add rejects a start point of the wrong size, a size of zero and a missing
+//   evaluation function
+// - an exception thrown by an evaluation function comes out of exec, and the
+//   batch can run again afterwards
+
+#include "nm_batch.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <stdexcept>
+
+
+static int failures = 0;
+
+static void check(bool condition, const char * what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static const char * orderNames[] = { "Arrival", "Grouped", "Interleaved" };
+
+// A shifted Rosenbrock function whose minimum depends on the problem
+static double shiftedRosenbrock(const std::vector<double> & x, double shift)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i + 1 < x.size(); i++) {
+        double xi = x[i] - shift;
+        double a = x[i + 1] - shift - xi * xi;
+        double b = 1.0 - xi;
+        sum += 100.0 * a * a + b * b;
+    }
+    return sum;
+}
+
+static void floorConstraint(std::vector<double> & x)
+{
+    for (double & xi : x) {
+        if (xi < -1.0) {
+            xi = -1.0;
+        }
+    }
+}
+
+static std::vector<NelderMeadBatchProblem> makeProblems()
+{
+    std::vector<NelderMeadBatchProblem> problems;
+    for (uint32_t i = 0; i < 40; i++) {
+        NelderMeadBatchProblem problem;
+        problem.localityKey = i % 3;
+        problem.size = 2 + i % 4;
+        double shift = 0.05 * i;
+        problem.evalFunc = [shift](const std::vector<double> & x) { return shiftedRosenbrock(x, shift); };
+        if (i % 5 == 0) {
+            problem.constrainFunc = floorConstraint;
+        }
+        problem.start.assign(problem.size, -1.2);
+        problem.tolerance = 1.0e-10;
+        problem.scale = 0.5 + 0.1 * (i % 7);
+        problems.push_back(problem);
+    }
+    return problems;
+}
+
+static bool sameResults(const NelderMeadResults & a, const NelderMeadResults & b)
+{
+    return a.evalCount == b.evalCount && a.iterationCount == b.iterationCount &&
+        memcmp(&a.min, &b.min, sizeof(double)) == 0 &&
+        a.minValues.size() == b.minValues.size() &&
+        memcmp(a.minValues.data(), b.minValues.data(), a.minValues.size() * sizeof(double)) == 0;
+}
+
+static void checkMatchesExec()
+{
+    std::vector<NelderMeadBatchProblem> problems = makeProblems();
+
+    std::vector<NelderMeadResults> expected;
+    for (const NelderMeadBatchProblem & problem : problems) {
+        NelderMead solver(problem.size, problem.evalFunc, problem.constrainFunc);
+        solver.setMaxIterations(3000);
+        solver.exec(problem.start, problem.tolerance, problem.scale);
+        expected.push_back(solver.getLastExecResults());
+    }
+
+    for (uint32_t threads : { 1u, 4u }) {
+        for (int order = 0; order < 3; order++) {
+            NelderMeadBatch batch(threads);
+            batch.setOrder((NelderMeadBatchOrder)order);
+            batch.setInterleaveWidth(3);
+            batch.setMaxIterations(3000);
+            for (const NelderMeadBatchProblem & problem : problems) {
+                batch.add(problem);
+            }
+
+            bool same = true;
+            for (int run = 0; run < 2; run++) {
+                batch.exec();
+                const std::vector<NelderMeadResults> & results = batch.getLastExecResults();
+                for (size_t i = 0; i < problems.size(); i++) {
+                    same = same && sameResults(results[i], expected[i]);
+                }
+            }
+            printf("%s, %u threads: %s exec\n", orderNames[order], threads, same ? "same as" : "differs from");
+            check(same, orderNames[order]);
+        }
+    }
+}
+
+static bool addThrows(const NelderMeadBatchProblem & problem)
+{
+    NelderMeadBatch batch(1);
+    try {
+        batch.add(problem);
+    }
+    catch (const std::invalid_argument &) {
+        return true;
+    }
+    return false;
+}
+
+static void checkArguments()
+{
+    NelderMeadBatchProblem problem = makeProblems()[0];
+    check(!addThrows(problem), "add accepts a valid problem");
+
+    NelderMeadBatchProblem wrongStart = problem;
+    wrongStart.start.push_back(0.0);
+    check(addThrows(wrongStart), "add rejects a start point of the wrong size");
+
+    NelderMeadBatchProblem noSize = problem;
+    noSize.size = 0;
+    noSize.start.clear();
+    check(addThrows(noSize), "add rejects a size of zero");
+
+    NelderMeadBatchProblem noFunc = problem;
+    noFunc.evalFunc = nullptr;
+    check(addThrows(noFunc), "add rejects a missing evaluation function");
+}
+
+static void checkException()
+{
+    std::vector<NelderMeadBatchProblem> problems = makeProblems();
+    NelderMeadBatchProblem failing = problems[7];
+    failing.evalFunc = [](const std::vector<double> & x) -> double {
+        if (x[0] > 0.0) {
+            throw std::runtime_error("evaluation failed");
+        }
+        return x[0] * x[0];
+    };
+
+    for (uint32_t threads : { 1u, 4u }) {
+        NelderMeadBatch batch(threads);
+        for (const NelderMeadBatchProblem & problem : problems) {
+            batch.add(problem);
+        }
+        batch.add(failing);
+
+        bool thrown = false;
+        try {
+            batch.exec();
+        }
+        catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        check(thrown, "an evaluation exception comes out of exec");
+
+        // the same solvers run a clean batch afterwards
+        batch.clear();
+        for (const NelderMeadBatchProblem & problem : problems) {
+            batch.add(problem);
+        }
+        batch.exec();
+        bool complete = true;
+        for (const NelderMeadResults & results : batch.getLastExecResults()) {
+            complete = complete && results.evalCount > 0;
+        }
+        printf("%u threads: exception %s, next batch %s\n", threads, thrown ? "rethrown" : "lost", complete ? "complete" : "incomplete");
+        check(complete, "a batch runs after an exception");
+    }
+}
+
+int main()
+{
+    checkMatchesExec();
+    checkArguments();
+    checkException();
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
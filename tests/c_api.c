@@ -0,0 +1,203 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+/*
+    Checks the C interface from C99. The same searches are driven by nm_run
+    and by nm_start, nm_ask and nm_tell, and must give the same results bit
+    for bit, including the number of batches. Every strategy is tried, with
+    and without a constraint. Also checks that configuration changed during
+    a search is left for the next one, the argument and state errors, and
+    the buffer sizes for the largest problem size.
+
+    Built with a C compiler and linked with the solver:
+
+        gcc -std=c99 -Isrc -c tests/c_api.c -o c_api.o
+        g++ -std=c++17 -Isrc c_api.o src/nm_c.cpp src/nm.cpp src/nm_pool.cpp -pthread -o c_api
+*/
+
+/* system headers */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* project headers */
+#include "nm_c.h"
+
+
+static int failures = 0;
+
+static void check(int condition, const char * what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static double rosenbrock(uint32_t size, const double * x)
+{
+    double sum = 0.0;
+    for (uint32_t i = 0; i + 1 < size; i++) {
+        double a = x[i + 1] - x[i] * x[i];
+        double b = 1.0 - x[i];
+        sum += 100.0 * a * a + b * b;
+    }
+    return sum;
+}
+
+static void batchObjective(void * user, uint32_t count, uint32_t size, const double * points, double * values)
+{
+    uint32_t * batches = (uint32_t *)user;
+    (*batches)++;
+    for (uint32_t i = 0; i < count; i++) {
+        values[i] = rosenbrock(size, points + (size_t)i * size);
+    }
+}
+
+/* keeps every coordinate at or above -1 */
+static void floorConstraint(void * user, uint32_t size, double * point)
+{
+    (void)user;
+    for (uint32_t j = 0; j < size; j++) {
+        if (point[j] < -1.0) {
+            point[j] = -1.0;
+        }
+    }
+}
+
+static void configure(nm_solver * solver, int strategy, int constrained)
+{
+    nm_set_max_iterations(solver, 5000);
+    nm_set_strategy(solver, strategy);
+    nm_set_constraint(solver, constrained ? floorConstraint : NULL, NULL);
+}
+
+static void checkSame(uint32_t size, int strategy, int constrained)
+{
+    double start[8];
+    double runMin[8];
+    double askMin[8];
+    nm_results runResults;
+    nm_results askResults;
+    uint32_t callbacks = 0;
+    char what[128];
+
+    for (uint32_t j = 0; j < size; j++) {
+        start[j] = -1.2 + 0.1 * j;
+    }
+
+    nm_solver * solver = nm_create(size);
+    configure(solver, strategy, constrained);
+    check(nm_run(solver, start, 1.0e-10, 1.0, batchObjective, &callbacks) == NM_OK, "nm_run");
+    nm_get_results(solver, &runResults, runMin);
+    nm_destroy(solver);
+
+    double * points = (double *)malloc(nm_points_capacity(size) * sizeof(double));
+    double * values = (double *)malloc(nm_values_capacity(size) * sizeof(double));
+    solver = nm_create(size);
+    configure(solver, strategy, constrained);
+    check(nm_start(solver, start, 1.0e-10, 1.0) == NM_OK, "nm_start");
+    while (!nm_is_done(solver)) {
+        uint32_t count = nm_ask(solver, points);
+        for (uint32_t i = 0; i < count; i++) {
+            values[i] = rosenbrock(size, points + (size_t)i * size);
+        }
+        nm_tell(solver, values);
+    }
+    nm_get_results(solver, &askResults, askMin);
+    nm_destroy(solver);
+    free(points);
+    free(values);
+
+    snprintf(what, sizeof(what), "size %u strategy %d constrained %d", size, strategy, constrained);
+    printf("%s: %u evaluations, %u batches, min %.17g\n", what, runResults.evalCount, runResults.batchCount, runResults.min);
+
+    check(runResults.evalCount == askResults.evalCount, what);
+    check(runResults.iterationCount == askResults.iterationCount, what);
+    check(runResults.batchCount == askResults.batchCount, what);
+    check(runResults.batchCount == callbacks, what);
+    check(memcmp(&runResults.min, &askResults.min, sizeof(double)) == 0, what);
+    check(memcmp(runMin, askMin, size * sizeof(double)) == 0, what);
+}
+
+static void checkConfigurationChange(void)
+{
+    double start[2] = { -1.2, 1.0 };
+    double points[6];
+    double values[3];
+    nm_results expected;
+    nm_results changed;
+    uint32_t callbacks = 0;
+
+    nm_solver * solver = nm_create(2);
+    nm_set_max_iterations(solver, 5000);
+    check(nm_start(solver, start, 1.0e-10, 1.0) == NM_OK, "nm_start");
+    nm_set_max_iterations(solver, 1);
+    nm_set_reflection_coefficient(solver, 2.0);
+    nm_set_contraction_coefficient(solver, 0.25);
+    nm_set_expansion_coefficient(solver, 3.0);
+    nm_set_strategy(solver, NM_STRATEGY_REPEATED_EXPANSION);
+    while (!nm_is_done(solver)) {
+        uint32_t count = nm_ask(solver, points);
+        for (uint32_t i = 0; i < count; i++) {
+            values[i] = rosenbrock(2, points + (size_t)i * 2);
+        }
+        nm_tell(solver, values);
+    }
+    nm_get_results(solver, &changed, NULL);
+    nm_destroy(solver);
+
+    solver = nm_create(2);
+    nm_set_max_iterations(solver, 5000);
+    nm_run(solver, start, 1.0e-10, 1.0, batchObjective, &callbacks);
+    nm_get_results(solver, &expected, NULL);
+    nm_destroy(solver);
+
+    printf("configuration changed during a search: %u evaluations, %u without the change\n", changed.evalCount, expected.evalCount);
+    check(changed.evalCount == expected.evalCount && changed.iterationCount == expected.iterationCount &&
+        memcmp(&changed.min, &expected.min, sizeof(double)) == 0, "configuration changed during a search is not used by it");
+}
+
+static void checkErrors(void)
+{
+    double start[2] = { 0.0, 0.0 };
+    double values[3];
+    nm_results results;
+
+    check(nm_abi_version() == NM_ABI_VERSION, "nm_abi_version");
+    check(nm_create(0) == NULL, "nm_create with a size of zero");
+
+    nm_solver * solver = nm_create(2);
+    check(nm_set_strategy(solver, 4) == NM_ERROR_ARGUMENT, "nm_set_strategy out of range");
+    check(nm_start(NULL, start, 1.0e-6, 1.0) == NM_ERROR_ARGUMENT, "nm_start with a null handle");
+    check(nm_tell(solver, values) == NM_ERROR_STATE, "nm_tell before nm_start");
+    check(nm_get_results(solver, &results, NULL) == NM_ERROR_STATE, "nm_get_results before a search");
+    nm_destroy(solver);
+
+    /* (size + 1) * size does not fit in 32 bits for the largest size */
+    if (sizeof(size_t) >= 8) {
+        check(nm_points_capacity(UINT32_MAX) == ((size_t)UINT32_MAX + 1) * UINT32_MAX, "nm_points_capacity for the largest size");
+        check(nm_values_capacity(UINT32_MAX) == (size_t)UINT32_MAX + 1, "nm_values_capacity for the largest size");
+    }
+}
+
+int main(void)
+{
+    uint32_t sizes[] = { 2, 5 };
+
+    for (int s = 0; s < 2; s++) {
+        for (int strategy = NM_STRATEGY_GREEDY_MINIMIZATION; strategy <= NM_STRATEGY_INSIDE_CONTRACTION_ONLY; strategy++) {
+            checkSame(sizes[s], strategy, 0);
+            checkSame(sizes[s], strategy, 1);
+        }
+    }
+    checkConfigurationChange();
+    checkErrors();
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Checks that a CmaEs search does not depend on how its points are
+// evaluated: one after the other, on 2, 4 and 7 threads, or by a batch
+// evaluation function that works through them backwards all give the same
+// results, bit for bit, without restarts and with IPOP and BIPOP restarts.
+// Also checks that exec rejects a search with no variables and a start point
+// of the wrong size.
+
+#include "cmaes.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <stdexcept>
+
+
+static int failures = 0;
+
+static void check(bool condition, const char * what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static double rastrigin(const std::vector<double> & x)
+{
+    double sum = 10.0 * x.size();
+    for (double xi : x) {
+        sum += xi * xi - 10.0 * cos(2.0 * M_PI * xi);
+    }
+    return sum;
+}
+
+static bool sameResults(const NelderMeadResults & a, const NelderMeadResults & b)
+{
+    return a.evalCount == b.evalCount && a.iterationCount == b.iterationCount
+        && memcmp(&a.min, &b.min, sizeof(double)) == 0 && a.minValues.size() == b.minValues.size()
+        && memcmp(a.minValues.data(), b.minValues.data(), a.minValues.size() * sizeof(double)) == 0;
+}
+
+static void checkDeterminism()
+{
+    static const char * restartNames[] = { "no restarts", "IPOP", "BIPOP" };
+    static const char * modeNames[] = { "serial", "batch", "2 threads", "4 threads", "7 threads" };
+    static const uint32_t threadCounts[] = { 1, 1, 2, 4, 7 };
+    const uint32_t size = 6;
+
+    for (CmaEsRestart restart : { CmaEsRestart::None, CmaEsRestart::Ipop, CmaEsRestart::Bipop }) {
+        NelderMeadResults first;
+        uint32_t firstRuns = 0;
+
+        for (uint32_t mode = 0; mode < 5; mode++) {
+            CmaEs es(size, rastrigin, nullptr);
+            es.setSeed(7);
+            es.setRestart(restart);
+            es.setMaxRestarts(4);
+            es.setMaxEvaluations(40000);
+            if (mode == 1) {
+                es.setBatchEvalFunc([](uint32_t count, const std::vector<double>* const* points, double * values) {
+                    for (uint32_t k = count; k-- > 0;) {
+                        values[k] = rastrigin(*points[k]);
+                    }
+                });
+            }
+            else {
+                es.setThreadCount(threadCounts[mode]);
+            }
+            es.exec(std::vector<double>(size, 3.0), 1.0e-10, 3.0);
+
+            const NelderMeadResults & results = es.getLastExecResults();
+            printf("%s, %s: %u runs, %u evaluations, %u generations, min %.17g\n", restartNames[(int)restart],
+                modeNames[mode], es.getRunCount(), results.evalCount, results.iterationCount, results.min);
+            if (mode == 0) {
+                first = results;
+                firstRuns = es.getRunCount();
+                check(restart == CmaEsRestart::None || firstRuns > 1, "restarts are made");
+            }
+            else {
+                check(sameResults(results, first) && es.getRunCount() == firstRuns, "the search does not depend on how points are evaluated");
+            }
+        }
+    }
+}
+
+static bool execThrows(CmaEs & es, const std::vector<double> & start)
+{
+    try {
+        es.exec(start, 1.0e-8, 1.0);
+    }
+    catch (const std::invalid_argument &) {
+        return true;
+    }
+    return false;
+}
+
+static void checkErrors()
+{
+    CmaEs empty(0, rastrigin, nullptr);
+    check(execThrows(empty, std::vector<double>()), "a search with no variables throws");
+
+    CmaEs es(3, rastrigin, nullptr);
+    check(execThrows(es, std::vector<double>(2, 0.0)), "a start point of the wrong size throws");
+    check(!execThrows(es, std::vector<double>(3, 0.0)), "a start point of the right size does not");
+    printf("errors checked\n");
+}
+
+int main()
+{
+    checkDeterminism();
+    checkErrors();
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
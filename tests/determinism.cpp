@@ -0,0 +1,73 @@
+
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Checks that the results of a search do not depend on the number of threads
+// its vector kernels are split across. Returns 0 if every thread count gives
+// the same results, bit for bit, as a single thread.
+//
+// Best run under ThreadSanitizer as well, for example:
+//
+//     g++ -std=c++17 -O1 -g -fsanitize=thread -Isrc tests/determinism.cpp src/nm.cpp src/nm_pool.cpp -pthread
+
+#include "nm.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+static double weightedQuadratic(const std::vector<double> & x)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < x.size(); i++) {
+        sum += (i % 7 + 1) * (x[i] - 0.5) * (x[i] - 0.5);
+    }
+    return sum;
+}
+
+// Runs one search per thread count and compares each with the first
+static bool checkSize(uint32_t size, uint32_t threshold, uint32_t maxIterations, const std::vector<uint32_t> & threadCounts)
+{
+    NelderMead solver(size, weightedQuadratic, nullptr);
+    solver.setMaxIterations(maxIterations);
+    solver.setParallelThreshold(threshold);
+
+    NelderMeadResults first;
+    bool same = true;
+    for (size_t t = 0; t < threadCounts.size(); t++) {
+        solver.setThreadCount(threadCounts[t]);
+        solver.exec(std::vector<double>(size, 0.0), 1.0e-9, 1.0);
+        const NelderMeadResults & results = solver.getLastExecResults();
+
+        if (t == 0) {
+            first = results;
+        }
+        else {
+            bool match = results.evalCount == first.evalCount
+                && results.iterationCount == first.iterationCount
+                && memcmp(&results.min, &first.min, sizeof(double)) == 0
+                && memcmp(results.minValues.data(), first.minValues.data(), size * sizeof(double)) == 0;
+            same = same && match;
+        }
+        printf("size %u threshold %u threads %u: %u evaluations, min %.17g\n",
+            size, threshold, threadCounts[t], results.evalCount, results.min);
+    }
+    return same;
+}
+
+int main()
+{
+    bool same = true;
+
+    // A low threshold so that a small problem goes through every parallel kernel
+    same = checkSize(300, 16, 3000, { 1, 2, 3, 4, 8 }) && same;
+
+    // Just above the default threshold
+    same = checkSize(9000, 8192, 30, { 1, 4 }) && same;
+
+    printf(same ? "PASS\n" : "FAIL: results depend on the thread count\n");
+    return same ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Checks NelderMeadEquality:
+//
+// - results satisfy A x = b to rounding and are the known minimum of a
+//   weighted quadratic, also with a dependent equality and with a constraint
+//   function in the original coordinates
+// - contradicting equalities are reported by isConsistent() and make exec
+//   throw, and that decision does not change when a row and its value are
+//   scaled by 1e9 or 1e-9
+// - searching the null space takes fewer evaluations than searching all the
+//   variables with a constraint function that projects onto the equalities
+
+#include "nm_equality.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include <stdexcept>
+
+
+static int failures = 0;
+
+static void check(bool condition, const char * what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// Three orthogonal equalities in 8 variables
+static const std::vector<std::vector<double>> rowsA = {
+    { 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 },
+    { 1.0, -1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+    { 0.0, 0.0, 1.0, -1.0, 1.0, -1.0, 0.0, 0.0 }
+};
+static const std::vector<double> valuesB = { 1.0, 0.1, 0.2 };
+
+// sum (i + 1) (x_i - 0.1 i)^2
+static double weightedQuadratic(const std::vector<double> & x)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < x.size(); i++) {
+        double d = x[i] - 0.1 * i;
+        sum += (i + 1) * d * d;
+    }
+    return sum;
+}
+
+// The minimum of weightedQuadratic on A x = b, from its optimality conditions:
+// x = t + W^-1 A^T u, where (A W^-1 A^T) u = b - A t
+static std::vector<double> exactMinimum()
+{
+    const size_t n = 8;
+    const size_t m = rowsA.size();
+    std::vector<std::vector<double>> g(m, std::vector<double>(m + 1, 0.0));
+    for (size_t r = 0; r < m; r++) {
+        for (size_t c = 0; c < m; c++) {
+            for (size_t j = 0; j < n; j++) {
+                g[r][c] += rowsA[r][j] * rowsA[c][j] / (j + 1);
+            }
+        }
+        g[r][m] = valuesB[r];
+        for (size_t j = 0; j < n; j++) {
+            g[r][m] -= rowsA[r][j] * 0.1 * j;
+        }
+    }
+
+    // Gauss-Jordan elimination; the matrix is positive definite
+    for (size_t k = 0; k < m; k++) {
+        for (size_t r = 0; r < m; r++) {
+            if (r != k) {
+                double f = g[r][k] / g[k][k];
+                for (size_t c = k; c <= m; c++) {
+                    g[r][c] -= f * g[k][c];
+                }
+            }
+        }
+    }
+
+    std::vector<double> x(n);
+    for (size_t j = 0; j < n; j++) {
+        x[j] = 0.1 * j;
+        for (size_t r = 0; r < m; r++) {
+            x[j] += rowsA[r][j] * (g[r][m] / g[r][r]) / (j + 1);
+        }
+    }
+    return x;
+}
+
+static double residual(const std::vector<std::vector<double>> & a, const std::vector<double> & b, const std::vector<double> & x)
+{
+    double most = 0.0;
+    for (size_t r = 0; r < a.size(); r++) {
+        double sum = -b[r];
+        for (size_t j = 0; j < x.size(); j++) {
+            sum += a[r][j] * x[j];
+        }
+        most = fabs(sum) > most ? fabs(sum) : most;
+    }
+    return most;
+}
+
+// Keeps the last variable at or below 0.5; without it the minimum is at 0.61
+static void capLast(std::vector<double> & x)
+{
+    if (x[7] > 0.5) {
+        x[7] = 0.5;
+    }
+}
+
+static void checkFeasible()
+{
+    std::vector<double> exact = exactMinimum();
+
+    // the same equalities, and again with a dependent row added: the sum of
+    // the first two
+    std::vector<std::vector<double>> dependentA = rowsA;
+    std::vector<double> dependentB = valuesB;
+    dependentA.push_back({ 2.0, 0.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 });
+    dependentB.push_back(1.1);
+
+    for (int dependent = 0; dependent < 2; dependent++) {
+        const std::vector<std::vector<double>> & a = dependent ? dependentA : rowsA;
+        const std::vector<double> & b = dependent ? dependentB : valuesB;
+
+        NelderMeadEquality equality(8, a, b, weightedQuadratic);
+        equality.getSolver().setMaxIterations(100000);
+        equality.exec(std::vector<double>(8, 0.0), 1.0e-14, 1.0);
+        const NelderMeadResults & results = equality.getLastExecResults();
+
+        double distance = 0.0;
+        for (size_t j = 0; j < exact.size(); j++) {
+            distance = fabs(results.minValues[j] - exact[j]) > distance ? fabs(results.minValues[j] - exact[j]) : distance;
+        }
+        printf("%s: %u variables searched, |A x - b| %.1e, %.1e from the exact minimum\n",
+            dependent ? "with a dependent row" : "independent rows", equality.getReducedSize(), residual(a, b, results.minValues), distance);
+        check(equality.isConsistent(), "consistent equalities");
+        check(equality.getReducedSize() == 5, "one variable fewer for each independent equality");
+        check(residual(a, b, results.minValues) < 1.0e-14, "results satisfy A x = b");
+        check(distance < 1.0e-5, "results are the minimum");
+    }
+
+    // with a constraint that holds at the start point, the result keeps to
+    // both the constraint and the equalities
+    NelderMeadEquality capped(8, rowsA, valuesB, weightedQuadratic, capLast);
+    capped.getSolver().setMaxIterations(100000);
+    capped.exec(std::vector<double>(8, 0.0), 1.0e-14, 1.0);
+    const std::vector<double> & x = capped.getLastExecResults().minValues;
+    printf("with a constraint: last variable %.6f, |A x - b| %.1e\n", x[7], residual(rowsA, valuesB, x));
+    check(x[7] <= 0.5 + 1.0e-12, "results keep to the constraint");
+    check(residual(rowsA, valuesB, x) < 1.0e-12, "constrained results satisfy A x = b");
+}
+
+static bool execThrows(NelderMeadEquality & equality)
+{
+    try {
+        equality.exec(std::vector<double>(3, 0.0), 1.0e-10, 1.0);
+    }
+    catch (const std::invalid_argument &) {
+        return true;
+    }
+    return false;
+}
+
+static void checkConsistency()
+{
+    // The third row is the first minus the second. Its value is right, or off
+    // by a thousandth of the size of the row's terms.
+    for (double rowScale : { 1.0, 1.0e9, 1.0e-9 }) {
+        for (int contradict = 0; contradict < 2; contradict++) {
+            double s = rowScale;
+            std::vector<std::vector<double>> a = {
+                { 0.3 * s, 0.7 * s, 0.1 * s },
+                { 0.3 * s, 0.1 * s, 0.9 * s },
+                { 0.0, 0.6 * s, -0.8 * s }
+            };
+            std::vector<double> b = { 0.37 * s, 0.37 * s, contradict ? 1.0e-3 * s : 0.0 };
+
+            NelderMeadEquality equality(3, a, b, weightedQuadratic);
+            bool consistent = equality.isConsistent();
+            bool thrown = execThrows(equality);
+            printf("rows scaled by %.0e, %s: %s, exec %s\n", rowScale, contradict ? "contradicting" : "dependent",
+                consistent ? "consistent" : "not consistent", thrown ? "throws" : "runs");
+            check(consistent == !contradict, "isConsistent reports contradicting equalities");
+            check(thrown == !!contradict, "exec throws for contradicting equalities");
+        }
+    }
+}
+
+// Projects a point onto the orthogonal rows of A
+static void projectOnto(std::vector<double> & x)
+{
+    for (size_t r = 0; r < rowsA.size(); r++) {
+        double d = -valuesB[r];
+        double n = 0.0;
+        for (size_t j = 0; j < x.size(); j++) {
+            d += rowsA[r][j] * x[j];
+            n += rowsA[r][j] * rowsA[r][j];
+        }
+        for (size_t j = 0; j < x.size(); j++) {
+            x[j] -= rowsA[r][j] * d / n;
+        }
+    }
+}
+
+static void checkEvaluations()
+{
+    for (double tolerance : { 1.0e-10, 1.0e-12 }) {
+        NelderMeadEquality equality(8, rowsA, valuesB, weightedQuadratic);
+        equality.getSolver().setMaxIterations(100000);
+        equality.exec(std::vector<double>(8, 0.0), tolerance, 1.0);
+
+        NelderMead projected(8, weightedQuadratic, projectOnto);
+        projected.setMaxIterations(100000);
+        projected.exec(std::vector<double>(8, 0.0), tolerance, 1.0);
+
+        const NelderMeadResults & reduced = equality.getLastExecResults();
+        const NelderMeadResults & full = projected.getLastExecResults();
+        printf("tolerance %.0e: %u evaluations in the null space, %u with a projection, minimum %.12f and %.12f\n",
+            tolerance, reduced.evalCount, full.evalCount, reduced.min, full.min);
+        check(reduced.evalCount < full.evalCount, "the null space search takes fewer evaluations");
+        check(reduced.min <= full.min + 1.0e-9, "the null space search finds as good a minimum");
+    }
+}
+
+int main()
+{
+    checkFeasible();
+    checkConsistency();
+    checkEvaluations();
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
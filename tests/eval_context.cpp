@@ -0,0 +1,121 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Checks the point ids passed to context evaluation functions, with a context
+// evaluation function, a batch context evaluation function and both:
+//
+// - every point gets an id that was never used before
+// - a parent is always a point that was evaluated before the batch holding
+//   the point, and that is still held by the search
+// - every point is retired exactly once, and none is left after the search
+// - results are the same, bit for bit, as with a plain evaluation function
+
+#include "nm.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <set>
+
+
+static double rosenbrock(const std::vector<double> & x)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i + 1 < x.size(); i++) {
+        double a = x[i + 1] - x[i] * x[i];
+        double b = 1.0 - x[i];
+        sum += 100.0 * a * a + b * b;
+    }
+    return sum;
+}
+
+// Flat almost everywhere, which makes the search shrink
+static double steps(const std::vector<double> & x)
+{
+    double sum = 0.0;
+    for (double xi : x) {
+        sum += xi > 0.0 ? 1.0 : 0.0;
+    }
+    return sum;
+}
+
+enum class Mode { Context, BatchContext, Both };
+
+static bool checkIds(Mode mode, double (*func)(const std::vector<double>&), uint32_t size, uint32_t maxIterations)
+{
+    std::set<uint64_t> live;
+    std::set<uint64_t> retired;
+    uint32_t bad = 0;
+    uint32_t batches = 0;
+
+    // checks a point against the points held before its batch
+    auto checkPoint = [&](const NelderMeadEvalContext & context, const std::set<uint64_t> & before) {
+        if (live.count(context.pointId) || retired.count(context.pointId)) {
+            bad++;
+        }
+        if (context.parentId != 0 && !before.count(context.parentId)) {
+            bad++;
+        }
+    };
+
+    NelderMead solver(size, func, nullptr);
+    solver.setMaxIterations(maxIterations);
+    if (mode != Mode::BatchContext) {
+        solver.setContextEvalFunc([&](const std::vector<double> & x, const NelderMeadEvalContext & context) {
+            checkPoint(context, live);
+            live.insert(context.pointId);
+            return func(x);
+        });
+    }
+    if (mode != Mode::Context) {
+        solver.setBatchContextEvalFunc([&](uint32_t count, const std::vector<double>* const* points,
+            const NelderMeadEvalContext * contexts, double * values) {
+            batches++;
+            std::set<uint64_t> before = live;
+            for (uint32_t i = 0; i < count; i++) {
+                checkPoint(contexts[i], before);
+                values[i] = func(*points[i]);
+            }
+            for (uint32_t i = 0; i < count; i++) {
+                live.insert(contexts[i].pointId);
+            }
+        });
+    }
+    solver.setRetireFunc([&](uint64_t id) {
+        if (!live.erase(id)) {
+            bad++;
+        }
+        retired.insert(id);
+    });
+    solver.exec(std::vector<double>(size, -1.2), 1.0e-10, 1.0);
+
+    NelderMead plain(size, func, nullptr);
+    plain.setMaxIterations(maxIterations);
+    plain.exec(std::vector<double>(size, -1.2), 1.0e-10, 1.0);
+
+    const NelderMeadResults & a = solver.getLastExecResults();
+    const NelderMeadResults & b = plain.getLastExecResults();
+    bool same = a.evalCount == b.evalCount && memcmp(&a.min, &b.min, sizeof(double)) == 0 &&
+        memcmp(a.minValues.data(), b.minValues.data(), size * sizeof(double)) == 0;
+
+    printf("mode %d size %u: %u evaluations, %u batches, %u bad ids, %zu left, %s\n",
+        (int)mode, size, a.evalCount, batches, bad, live.size(), same ? "same" : "different");
+    return bad == 0 && live.empty() && same;
+}
+
+int main()
+{
+    bool passed = true;
+    for (Mode mode : { Mode::Context, Mode::BatchContext, Mode::Both }) {
+        for (uint32_t size : { 2u, 5u }) {
+            passed = checkIds(mode, rosenbrock, size, 5000) && passed;
+            passed = checkIds(mode, steps, size, 200) && passed;
+        }
+    }
+
+    printf(passed ? "PASS\n" : "FAIL\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,250 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Checks the evaluation farm against workers running on background threads of
+// this process, over tcp on a free port of 127.0.0.1 and over a unix socket:
+//
+// - searches through the farm give the same results, bit for bit, as searches
+//   that evaluate in process
+// - the points of a worker that is stopped in the middle of a search are sent
+//   to the other worker, and the search still gives the same results
+// - a worker that stays silent for longer than the heartbeat timeout while it
+//   has work is dropped, and its point is evaluated by the other worker
+// - a worker that sends a header with a count that does not fit its type is
+//   dropped at once, rather than waited on for the payload
+
+#include "nm.h"
+#include "nm_farm.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+
+static int failures = 0;
+
+static void check(bool condition, const char * what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static double rosenbrock(const std::vector<double> & x)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i + 1 < x.size(); i++) {
+        double a = x[i + 1] - x[i] * x[i];
+        double b = 1.0 - x[i];
+        sum += 100.0 * a * a + b * b;
+    }
+    return sum;
+}
+
+static bool sameResults(const NelderMeadResults & a, const NelderMeadResults & b)
+{
+    return a.evalCount == b.evalCount && a.iterationCount == b.iterationCount &&
+        memcmp(&a.min, &b.min, sizeof(double)) == 0 &&
+        a.minValues.size() == b.minValues.size() &&
+        memcmp(a.minValues.data(), b.minValues.data(), a.minValues.size() * sizeof(double)) == 0;
+}
+
+static NelderMeadResults solveInProcess(uint32_t size)
+{
+    NelderMead solver(size, rosenbrock, nullptr);
+    solver.exec(std::vector<double>(size, -1.2), 1.0e-10, 1.0);
+    return solver.getLastExecResults();
+}
+
+static NelderMeadResults solveOnFarm(uint32_t size, NelderMeadEvalFarm & farm)
+{
+    NelderMead solver(size, [&](const std::vector<double> & x) { return farm.evaluate(x); }, nullptr);
+    solver.setBatchEvalFunc([&](uint32_t n, const std::vector<double>* const* p, double * v) {
+        farm.evaluate(n, p, v);
+    });
+    solver.exec(std::vector<double>(size, -1.2), 1.0e-10, 1.0);
+    return solver.getLastExecResults();
+}
+
+// Results through a single worker listening on the endpoint
+static void checkEndpoint(const std::string & endpoint)
+{
+    NelderMeadFarmWorker worker(rosenbrock);
+    if (!worker.listen(endpoint)) {
+        check(false, ("listen on " + endpoint).c_str());
+        return;
+    }
+    worker.start();
+
+    NelderMeadEvalFarm farm({ worker.getEndpoint() });
+    check(farm.getWorkerCount() == 1, ("connect to " + worker.getEndpoint()).c_str());
+
+    for (uint32_t size : { 2u, 6u }) {
+        bool same = sameResults(solveInProcess(size), solveOnFarm(size, farm));
+        printf("%s size %u: %s\n", worker.getEndpoint().c_str(), size, same ? "same" : "different");
+        check(same, ("results through " + endpoint).c_str());
+    }
+
+    farm.shutdown();
+    worker.stop();
+}
+
+// Worker a is stopped while it evaluates its first point of the initial
+// simplex. The others it was sent must go to worker b.
+static void checkStoppedWorker()
+{
+    const uint32_t size = 7;
+    std::atomic<uint32_t> countA{ 0 };
+    std::atomic<uint32_t> countB{ 0 };
+    std::atomic<bool> busyA{ false };
+
+    NelderMeadFarmWorker workerA([&](const std::vector<double> & x) {
+        if (countA++ == 0) {
+            busyA = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        }
+        return rosenbrock(x);
+    });
+    NelderMeadFarmWorker workerB([&](const std::vector<double> & x) {
+        countB++;
+        return rosenbrock(x);
+    });
+    workerA.listen("tcp:127.0.0.1:0");
+    workerB.listen("tcp:127.0.0.1:0");
+    workerA.start();
+    workerB.start();
+
+    NelderMeadEvalFarm farm({ workerA.getEndpoint(), workerB.getEndpoint() });
+    check(farm.getWorkerCount() == 2, "connect to two workers");
+
+    std::thread stopper([&]() {
+        while (!busyA) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        workerA.stop();
+    });
+    NelderMeadResults results = solveOnFarm(size, farm);
+    stopper.join();
+
+    printf("stopped worker: a evaluated %u, b evaluated %u of %u\n",
+        countA.load(), countB.load(), results.evalCount);
+    check(sameResults(solveInProcess(size), results), "results with a worker stopped");
+    check(farm.getWorkerCount() == 1, "stopped worker dropped");
+    check(countA == 1, "stopped worker answers no more points");
+    check(countA + countB == results.evalCount, "points of the stopped worker evaluated once each by the other");
+
+    farm.shutdown();
+    workerB.stop();
+}
+
+// Worker a sends no heartbeats and takes much longer than the timeout to
+// answer, so its point has to be taken from it and given to worker b.
+static void checkHeartbeatTimeout()
+{
+    std::atomic<uint32_t> countB{ 0 };
+
+    NelderMeadFarmWorker workerA([&](const std::vector<double> & x) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        return rosenbrock(x);
+    });
+    NelderMeadFarmWorker workerB([&](const std::vector<double> & x) {
+        countB++;
+        return rosenbrock(x);
+    });
+    workerA.setHeartbeatInterval(60000);
+    workerA.listen("tcp:127.0.0.1:0");
+    workerB.listen("tcp:127.0.0.1:0");
+    workerA.start();
+    workerB.start();
+
+    NelderMeadEvalFarm farm({ workerA.getEndpoint(), workerB.getEndpoint() });
+    farm.setHeartbeatTimeout(200);
+
+    std::vector<double> point = { 0.5, 0.25 };
+    auto begin = std::chrono::steady_clock::now();
+    double value = farm.evaluate(point);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    printf("heartbeat timeout: answered in %.3f s\n", seconds);
+    check(value == rosenbrock(point), "value after the heartbeat timeout");
+    check(seconds < 0.9, "silent worker dropped before it answered");
+    check(farm.getWorkerCount() == 1, "silent worker dropped");
+    check(countB == 1, "point of the silent worker evaluated by the other");
+
+    farm.shutdown();
+    workerA.stop();
+    workerB.stop();
+}
+
+// A fake worker answers with a Result header claiming 0xFFFFFFFF doubles and
+// then holds the connection open for a second
+static void checkBadFrame()
+{
+    std::atomic<uint32_t> countB{ 0 };
+    NelderMeadFarmWorker workerB([&](const std::vector<double> & x) {
+        countB++;
+        return rosenbrock(x);
+    });
+    workerB.listen("tcp:127.0.0.1:0");
+    workerB.start();
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    bind(listener, (sockaddr*)&address, sizeof(address));
+    listen(listener, 1);
+    getsockname(listener, (sockaddr*)&address, &length);
+    std::string endpoint = "tcp:127.0.0.1:" + std::to_string(ntohs(address.sin_port));
+
+    std::thread fake([&]() {
+        int connection = accept(listener, nullptr, nullptr);
+        uint32_t header[6] = { 0x4D464D4E, 1, 2, 0xFFFFFFFF, 0, 0 };
+        send(connection, header, sizeof(header), 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        close(connection);
+    });
+
+    NelderMeadEvalFarm farm({ endpoint, workerB.getEndpoint() });
+    std::vector<double> point = { 0.5, 0.25 };
+    auto begin = std::chrono::steady_clock::now();
+    double value = farm.evaluate(point);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    printf("bad frame: answered in %.3f s\n", seconds);
+    check(value == rosenbrock(point), "value after a bad frame");
+    check(seconds < 0.9, "worker with a bad frame dropped at once");
+    check(farm.getWorkerCount() == 1, "worker with a bad frame dropped");
+    check(countB == 1, "point evaluated by the other worker");
+
+    fake.join();
+    close(listener);
+    farm.shutdown();
+    workerB.stop();
+}
+
+int main()
+{
+    checkEndpoint("tcp:127.0.0.1:0");
+    checkEndpoint("unix:/tmp/nm_farm_test_" + std::to_string((long)getpid()));
+    checkStoppedWorker();
+    checkHeartbeatTimeout();
+    checkBadFrame();
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Checks FixedNelderMead:
+//
+// - searches run at compile time converge: a line fit, the Rosenbrock
+//   function and quadratic and cubic fits in 3 and 4 parameters, the last
+//   one with a constraint. These are static_asserts, so a search that stops
+//   converging, or stops being a constant expression, fails the build.
+// - the same searches run by NelderMead take the same number of steps and
+//   find the same minimum. fixedNelderMeadSqrt can be a bit away from sqrt,
+//   which moves the initial simplex by as much, so results are compared to
+//   within a small tolerance rather than bit for bit.
+// - fixedNelderMeadSqrt passes infinity and NaN through and finds the
+//   square roots of ordinary values. Checked at run time, where the values
+//   come from outside.
+
+#include "nm.h"
+#include "nm_fixed.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include <limits>
+
+
+static int failures = 0;
+
+static void check(bool condition, const char * what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// Tables generated from y = 0.5 + 2 t, y = 1.5 - 0.5 t + 0.25 t^2 and
+// y = 1 - 0.5 t + 0.25 t^2 + 0.125 t^3
+constexpr std::array<double, 6> tableT = { 0.0, 1.0, 2.0, 3.0, 4.0, 5.0 };
+constexpr std::array<double, 6> lineY = { 0.5, 2.5, 4.5, 6.5, 8.5, 10.5 };
+constexpr std::array<double, 6> quadraticY = { 1.5, 1.25, 1.5, 2.25, 3.5, 5.25 };
+constexpr std::array<double, 6> cubicY = { 1.0, 0.875, 2.0, 5.125, 11.0, 20.375 };
+
+// Sum of squared residuals of the polynomial with coefficients x
+template <size_t N>
+constexpr double polynomialError(const std::array<double, N> & x, const std::array<double, 6> & y)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < tableT.size(); i++) {
+        double p = 0.0;
+        for (size_t k = N; k-- > 0;) {
+            p = p * tableT[i] + x[k];
+        }
+        double r = p - y[i];
+        sum += r * r;
+    }
+    return sum;
+}
+
+constexpr double lineError(const std::array<double, 2> & x) { return polynomialError(x, lineY); }
+constexpr double quadraticError(const std::array<double, 3> & x) { return polynomialError(x, quadraticY); }
+constexpr double cubicError(const std::array<double, 4> & x) { return polynomialError(x, cubicY); }
+
+constexpr double rosenbrock(const std::array<double, 2> & x)
+{
+    double a = x[1] - x[0] * x[0];
+    double b = 1.0 - x[0];
+    return 100.0 * a * a + b * b;
+}
+
+// Keeps the cubic's coefficients within [-2, 2]
+struct CubicConstraint {
+    constexpr void operator()(std::array<double, 4> & x) const
+    {
+        for (double & xi : x) {
+            if (xi < -2.0) {
+                xi = -2.0;
+            }
+            if (xi > 2.0) {
+                xi = 2.0;
+            }
+        }
+    }
+};
+
+constexpr bool near(double value, double expected)
+{
+    return value > expected - 1.0e-6 && value < expected + 1.0e-6;
+}
+
+constexpr auto lineFit = fixedNelderMead<2>(lineError, std::array<double, 2>{ 0.0, 0.0 }, 1.0e-14, 1.0);
+static_assert(lineFit.min < 1.0e-10, "line fit did not converge");
+static_assert(near(lineFit.minValues[0], 0.5) && near(lineFit.minValues[1], 2.0), "wrong line");
+
+constexpr auto rosenbrockFit = fixedNelderMead<2>(rosenbrock, std::array<double, 2>{ -1.2, 1.0 }, 1.0e-14, 1.0, 5000);
+static_assert(rosenbrockFit.min < 1.0e-12, "Rosenbrock search did not converge");
+static_assert(rosenbrockFit.minValues[0] > 0.9999 && rosenbrockFit.minValues[1] > 0.9999, "wrong Rosenbrock minimum");
+
+constexpr auto quadraticFit = fixedNelderMead<3>(quadraticError, std::array<double, 3>{ 0.0, 0.0, 0.0 }, 1.0e-16, 1.0, 5000);
+static_assert(quadraticFit.min < 1.0e-14, "quadratic fit did not converge");
+static_assert(near(quadraticFit.minValues[0], 1.5) && near(quadraticFit.minValues[1], -0.5) &&
+    near(quadraticFit.minValues[2], 0.25), "wrong quadratic");
+
+constexpr auto cubicFit = fixedNelderMead<4>(cubicError, std::array<double, 4>{ 0.0, 0.0, 0.0, 0.0 }, 1.0e-16, 1.0, 5000, CubicConstraint());
+static_assert(cubicFit.min < 1.0e-14, "cubic fit did not converge");
+static_assert(near(cubicFit.minValues[0], 1.0) && near(cubicFit.minValues[1], -0.5) &&
+    near(cubicFit.minValues[2], 0.25) && near(cubicFit.minValues[3], 0.125), "wrong cubic");
+
+// Runs the same search with NelderMead and compares it to the one run while
+// compiling
+template <size_t N, typename ConstrainFunc = FixedNelderMeadNoConstraint>
+static void checkSame(const char * name, double (*func)(const std::array<double, N>&), const FixedNelderMeadResults<N> & fixed,
+    const std::array<double, N> & start, double tolerance, uint32_t maxIterations, ConstrainFunc constrain = ConstrainFunc())
+{
+    NelderMead solver(N, [func](const std::vector<double> & x) {
+        std::array<double, N> point;
+        for (size_t j = 0; j < N; j++) {
+            point[j] = x[j];
+        }
+        return func(point);
+    }, [constrain](std::vector<double> & x) {
+        std::array<double, N> point;
+        for (size_t j = 0; j < N; j++) {
+            point[j] = x[j];
+        }
+        constrain(point);
+        for (size_t j = 0; j < N; j++) {
+            x[j] = point[j];
+        }
+    });
+    solver.setMaxIterations(maxIterations);
+    solver.exec(std::vector<double>(start.begin(), start.end()), tolerance, 1.0);
+    const NelderMeadResults & results = solver.getLastExecResults();
+
+    printf("%s: %u evaluations at compile time, %u with NelderMead\n", name, fixed.evalCount, results.evalCount);
+    bool same = results.evalCount == fixed.evalCount && results.iterationCount == fixed.iterationCount &&
+        fabs(results.min - fixed.min) <= 1.0e-12;
+    for (size_t j = 0; j < N; j++) {
+        same = same && fabs(results.minValues[j] - fixed.minValues[j]) <= 1.0e-9;
+    }
+    check(same, name);
+}
+
+static void checkSqrt()
+{
+    double inf = std::numeric_limits<double>::infinity();
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    volatile double values[] = { inf, nan, 0.0, -1.0, 2.0, 1.0e-300, 1.0e300 };
+
+    check(fixedNelderMeadSqrt(values[0]) == inf, "fixedNelderMeadSqrt of infinity");
+    double root = fixedNelderMeadSqrt(values[1]);
+    check(root != root, "fixedNelderMeadSqrt of NaN");
+    check(fixedNelderMeadSqrt(values[2]) == 0.0, "fixedNelderMeadSqrt of zero");
+    check(fixedNelderMeadSqrt(values[3]) == 0.0, "fixedNelderMeadSqrt of a negative value");
+    for (int i = 4; i < 7; i++) {
+        double x = values[i];
+        check(fabs(fixedNelderMeadSqrt(x) - sqrt(x)) <= 2.0e-16 * sqrt(x), "fixedNelderMeadSqrt of an ordinary value");
+    }
+}
+
+int main()
+{
+    checkSame<2>("line", lineError, lineFit, { 0.0, 0.0 }, 1.0e-14, 1000);
+    checkSame<2>("rosenbrock", rosenbrock, rosenbrockFit, { -1.2, 1.0 }, 1.0e-14, 5000);
+    checkSame<3>("quadratic", quadraticError, quadraticFit, { 0.0, 0.0, 0.0 }, 1.0e-16, 5000);
+    checkSame<4>("cubic", cubicError, cubicFit, { 0.0, 0.0, 0.0, 0.0 }, 1.0e-16, 5000, CubicConstraint());
+    checkSqrt();
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,236 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Checks NelderMeadMultilevel:
+//
+// - a smoothed curve fit reaches its exact minimum in fewer evaluations than
+//   a direct search, and the level results add up to the totals
+// - so it does with an affine prolongation, and with one whose coarse
+//   directions all coincide, which leaves the fine directions to complete
+//   the initial simplex
+// - addLevel rejects a level with no variables and a finer level without a
+//   prolongation or restriction; exec rejects no levels and a start point of
+//   the wrong size, and clears the results of the previous search when it does
+
+#include "nm_multilevel.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include <stdexcept>
+
+
+static int failures = 0;
+
+static void check(bool condition, const char * what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static const uint32_t fineSize = 16;
+static const double smoothing = 0.1;
+
+static double target(uint32_t i)
+{
+    double t = (double)i / (fineSize - 1);
+    return sin(3.0 * t) + 0.5 * t;
+}
+
+// Squared distance to the target plus the smoothing of neighboring knots
+static double curveFit(const std::vector<double> & x)
+{
+    double sum = 0.0;
+    for (uint32_t i = 0; i < fineSize; i++) {
+        double d = x[i] - target(i);
+        sum += d * d;
+    }
+    for (uint32_t i = 0; i + 1 < fineSize; i++) {
+        double d = x[i + 1] - x[i];
+        sum += smoothing * d * d;
+    }
+    return sum;
+}
+
+// The minimum of curveFit, where (I + smoothing L) x = target with L the
+// tridiagonal second difference matrix, by the Thomas algorithm
+static double exactMinimum()
+{
+    std::vector<double> diagonal(fineSize);
+    std::vector<double> right(fineSize);
+    for (uint32_t i = 0; i < fineSize; i++) {
+        uint32_t neighbors = (i > 0) + (i + 1 < fineSize);
+        diagonal[i] = 1.0 + smoothing * neighbors;
+        right[i] = target(i);
+    }
+    for (uint32_t i = 1; i < fineSize; i++) {
+        double f = -smoothing / diagonal[i - 1];
+        diagonal[i] += f * smoothing;
+        right[i] -= f * right[i - 1];
+    }
+    std::vector<double> x(fineSize);
+    for (uint32_t i = fineSize; i-- > 0;) {
+        x[i] = (right[i] + (i + 1 < fineSize ? smoothing * x[i + 1] : 0.0)) / diagonal[i];
+    }
+    return curveFit(x);
+}
+
+// Linear interpolation of the curve through the knots of one grid at the
+// knots of another
+static void resample(const std::vector<double> & from, std::vector<double> & to)
+{
+    size_t n = from.size();
+    size_t m = to.size();
+    for (size_t i = 0; i < m; i++) {
+        double t = (double)i / (m - 1) * (n - 1);
+        size_t k = (size_t)t;
+        if (k >= n - 1) {
+            k = n - 2;
+        }
+        double w = t - k;
+        to[i] = from[k] * (1.0 - w) + from[k + 1] * w;
+    }
+}
+
+// Interpolation shifted up by one, and its inverse
+static void shiftedProlong(const std::vector<double> & coarse, std::vector<double> & fine)
+{
+    resample(coarse, fine);
+    for (auto & x : fine) {
+        x += 1.0;
+    }
+}
+
+static void shiftedRestrict(const std::vector<double> & fine, std::vector<double> & coarse)
+{
+    resample(fine, coarse);
+    for (auto & x : coarse) {
+        x -= 1.0;
+    }
+}
+
+// Every fine knot takes the mean of the coarse knots, so every coarse
+// direction prolongs to the same fine direction
+static void meanProlong(const std::vector<double> & coarse, std::vector<double> & fine)
+{
+    double mean = 0.0;
+    for (double x : coarse) {
+        mean += x;
+    }
+    mean /= coarse.size();
+    for (auto & x : fine) {
+        x = mean;
+    }
+}
+
+enum class Prolongation { Linear, Shifted, Mean };
+
+static void addLevels(NelderMeadMultilevel & multilevel, Prolongation prolongation)
+{
+    for (uint32_t size : { 4u, 8u, 16u }) {
+        NelderMeadLevel level;
+        level.size = size;
+        if (size > 4) {
+            level.prolongFunc = prolongation == Prolongation::Shifted ? shiftedProlong
+                : (prolongation == Prolongation::Mean ? meanProlong : resample);
+            level.restrictFunc = prolongation == Prolongation::Shifted ? shiftedRestrict : resample;
+        }
+        multilevel.addLevel(level);
+    }
+}
+
+static void checkMinimum()
+{
+    static const char * names[] = { "linear", "shifted", "mean" };
+    double exact = exactMinimum();
+
+    NelderMead direct(fineSize, curveFit, nullptr);
+    direct.setMaxIterations(1000000);
+    direct.exec(std::vector<double>(fineSize, 0.0), 1.0e-12, 0.5);
+    const NelderMeadResults & directResults = direct.getLastExecResults();
+    printf("direct: %u evaluations, %.3e above the exact minimum %.12f\n", directResults.evalCount, directResults.min - exact, exact);
+
+    for (Prolongation prolongation : { Prolongation::Linear, Prolongation::Shifted, Prolongation::Mean }) {
+        NelderMeadMultilevel multilevel(curveFit);
+        addLevels(multilevel, prolongation);
+        multilevel.setMaxIterations(1000000);
+        multilevel.exec(std::vector<double>(fineSize, 0.0), 1.0e-12, 0.5);
+
+        const NelderMeadResults & results = multilevel.getLastExecResults();
+        const std::vector<NelderMeadResults> & levels = multilevel.getLevelResults();
+        uint32_t evalCount = 0;
+        uint32_t iterationCount = 0;
+        bool sizes = levels.size() == 3;
+        for (size_t k = 0; k < levels.size(); k++) {
+            evalCount += levels[k].evalCount;
+            iterationCount += levels[k].iterationCount;
+            sizes = sizes && levels[k].minValues.size() == (4u << k);
+        }
+        printf("%s prolongation: %u evaluations, %.3e above the exact minimum\n", names[(int)prolongation],
+            results.evalCount, results.min - exact);
+
+        check(results.min - exact < 1.0e-9, "the exact minimum is reached");
+        check(fabs(curveFit(results.minValues) - results.min) < 1.0e-15, "the minimum is at the reported point");
+        check(sizes, "each level reports its minimum at its own resolution");
+        check(results.evalCount == evalCount && results.iterationCount == iterationCount, "the level results add up to the totals");
+        if (prolongation == Prolongation::Linear) {
+            check(results.evalCount < directResults.evalCount, "fewer evaluations than a direct search");
+        }
+    }
+}
+
+template <typename Func>
+static bool throws(Func func)
+{
+    try {
+        func();
+    }
+    catch (const std::invalid_argument &) {
+        return true;
+    }
+    return false;
+}
+
+static void checkErrors()
+{
+    NelderMeadLevel empty;
+    NelderMeadLevel coarse;
+    coarse.size = 4;
+    NelderMeadLevel noProlong;
+    noProlong.size = 8;
+    noProlong.restrictFunc = resample;
+    NelderMeadLevel noRestrict;
+    noRestrict.size = 8;
+    noRestrict.prolongFunc = resample;
+
+    NelderMeadMultilevel multilevel(curveFit);
+    check(throws([&] { multilevel.addLevel(empty); }), "a level with no variables throws");
+    check(throws([&] { multilevel.exec(std::vector<double>(fineSize, 0.0), 1.0e-8, 0.5); }), "exec with no levels throws");
+    check(!throws([&] { multilevel.addLevel(coarse); }), "the coarsest level needs no operators");
+    check(throws([&] { multilevel.addLevel(noProlong); }), "a finer level without a prolongation throws");
+    check(throws([&] { multilevel.addLevel(noRestrict); }), "a finer level without a restriction throws");
+
+    NelderMeadMultilevel solved(curveFit);
+    addLevels(solved, Prolongation::Linear);
+    solved.exec(std::vector<double>(fineSize, 0.0), 1.0e-8, 0.5);
+    check(solved.getLastExecResults().evalCount > 0, "a search before the bad one");
+    check(throws([&] { solved.exec(std::vector<double>(8, 0.0), 1.0e-8, 0.5); }), "a start point of a coarser size throws");
+    const NelderMeadResults & cleared = solved.getLastExecResults();
+    check(cleared.evalCount == 0 && cleared.minValues.empty() && solved.getLevelResults().empty(),
+        "a rejected exec clears the previous results");
+    printf("errors checked\n");
+}
+
+int main()
+{
+    checkMinimum();
+    checkErrors();
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
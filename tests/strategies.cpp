@@ -0,0 +1,231 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Checks the step strategies:
+//
+// - with every strategy, exec with a plain evaluation function, exec with a
+//   batch evaluation function and start/tell give the same results and take
+//   the same steps, bit for bit
+// - InsideContractionOnly never takes an outside contraction, on problems
+//   where the default strategy does
+// - RepeatedExpansion stops after maxExpansions further steps on an objective
+//   that is unbounded below
+// - a strategy set while a search is running is used by the next search only
+
+#include "nm.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+static int failures = 0;
+
+static void check(bool condition, const char * what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static const char * strategyNames[] = { "GreedyMinimization", "GreedyExpansion", "RepeatedExpansion", "InsideContractionOnly" };
+
+static double rosenbrock(const std::vector<double> & x)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i + 1 < x.size(); i++) {
+        double a = x[i + 1] - x[i] * x[i];
+        double b = 1.0 - x[i];
+        sum += 100.0 * a * a + b * b;
+    }
+    return sum;
+}
+
+// Flat almost everywhere, which makes the search shrink
+static double steps(const std::vector<double> & x)
+{
+    double sum = 0.0;
+    for (double xi : x) {
+        sum += xi > 0.0 ? 1.0 : 0.0;
+    }
+    return sum;
+}
+
+// Unbounded below, so every expansion improves
+static double slope(const std::vector<double> & x)
+{
+    double sum = 0.0;
+    for (double xi : x) {
+        sum -= xi;
+    }
+    return sum;
+}
+
+static void floorConstraint(std::vector<double> & x)
+{
+    for (double & xi : x) {
+        if (xi < -1.0) {
+            xi = -1.0;
+        }
+    }
+}
+
+// Keeps the largest number of evaluations made by an iteration, not counting
+// the initial simplex
+struct EvalsPerIteration {
+    uint32_t last = 0;
+    uint32_t most = 0;
+
+    template <typename Solver>
+    bool iteration(const Solver & solver)
+    {
+        uint32_t evals = solver.getEvalCount();
+        if (solver.getIterationCount() > 1 && evals - last > most) {
+            most = evals - last;
+        }
+        last = evals;
+        return true;
+    }
+};
+
+struct CountedPolicies : NelderMeadDefaultPolicies {
+    using Callback = EvalsPerIteration;
+    using Instrumentation = NelderMeadStepCounter;
+};
+
+using CountedNelderMead = BasicNelderMead<CountedPolicies>;
+
+enum class Drive { Exec, Batch, AskTell };
+
+struct Run {
+    NelderMeadResults results;
+    uint32_t steps[5];
+};
+
+static Run solve(Drive drive, NelderMeadStrategy strategy, double (*func)(const std::vector<double>&), uint32_t size, bool constrained)
+{
+    CountedNelderMead solver(size, func, constrained ? NelderMeadFunctionConstraint(floorConstraint) : nullptr);
+    solver.setMaxIterations(3000);
+    solver.setStrategy(strategy);
+
+    std::vector<double> start(size, -1.2);
+    if (drive == Drive::AskTell) {
+        std::vector<double> values(size + 1);
+        solver.start(start, 1.0e-10, 1.0);
+        while (!solver.isDone()) {
+            for (uint32_t i = 0; i < solver.getPendingCount(); i++) {
+                values[i] = func(solver.getPendingPoint(i));
+            }
+            solver.tell(values.data());
+        }
+    }
+    else {
+        if (drive == Drive::Batch) {
+            solver.setBatchEvalFunc([&](uint32_t count, const std::vector<double>* const* points, double * values) {
+                for (uint32_t i = 0; i < count; i++) {
+                    values[i] = func(*points[i]);
+                }
+            });
+        }
+        solver.exec(start, 1.0e-10, 1.0);
+    }
+
+    Run run;
+    run.results = solver.getLastExecResults();
+    for (int s = 0; s < 5; s++) {
+        run.steps[s] = solver.getInstrumentation().getStepCount((NelderMeadStep)s);
+    }
+    return run;
+}
+
+static bool sameRun(const Run & a, const Run & b)
+{
+    return a.results.evalCount == b.results.evalCount && a.results.iterationCount == b.results.iterationCount &&
+        memcmp(&a.results.min, &b.results.min, sizeof(double)) == 0 &&
+        a.results.minValues.size() == b.results.minValues.size() &&
+        memcmp(a.results.minValues.data(), b.results.minValues.data(), a.results.minValues.size() * sizeof(double)) == 0 &&
+        memcmp(a.steps, b.steps, sizeof(a.steps)) == 0;
+}
+
+static void checkDrives()
+{
+    for (int s = 0; s < 4; s++) {
+        for (auto func : { rosenbrock, steps }) {
+            for (uint32_t size : { 2u, 5u, 20u }) {
+                for (bool constrained : { false, true }) {
+                    Run exec = solve(Drive::Exec, (NelderMeadStrategy)s, func, size, constrained);
+                    bool same = sameRun(exec, solve(Drive::Batch, (NelderMeadStrategy)s, func, size, constrained)) &&
+                        sameRun(exec, solve(Drive::AskTell, (NelderMeadStrategy)s, func, size, constrained));
+                    check(same, strategyNames[s]);
+                }
+            }
+        }
+        printf("%s: exec, batch exec and ask/tell give the same results\n", strategyNames[s]);
+    }
+}
+
+static void checkInsideContractionOnly()
+{
+    uint32_t defaultOutside = 0;
+    uint32_t insideOnlyOutside = 0;
+    for (uint32_t size : { 2u, 5u, 10u }) {
+        defaultOutside += solve(Drive::Exec, NelderMeadStrategy::GreedyMinimization, rosenbrock, size, false).steps[(int)NelderMeadStep::OutsideContraction];
+        insideOnlyOutside += solve(Drive::Exec, NelderMeadStrategy::InsideContractionOnly, rosenbrock, size, false).steps[(int)NelderMeadStep::OutsideContraction];
+    }
+    printf("outside contractions: %u with GreedyMinimization, %u with InsideContractionOnly\n", defaultOutside, insideOnlyOutside);
+    check(defaultOutside > 0, "GreedyMinimization takes outside contractions");
+    check(insideOnlyOutside == 0, "InsideContractionOnly takes no outside contractions");
+}
+
+static void checkMaxExpansions()
+{
+    CountedNelderMead solver(2, slope);
+    solver.setMaxIterations(10);
+    solver.setStrategy(NelderMeadStrategy::RepeatedExpansion);
+    solver.exec({ 0.0, 0.0 }, 1.0e-10, 1.0);
+
+    // a reflection, then the expansion and its further steps
+    uint32_t most = solver.getCallback().most;
+    printf("repeated expansion: at most %u evaluations in an iteration\n", most);
+    check(most == 2 + CountedNelderMead::maxExpansions, "repeated expansion stops at maxExpansions");
+}
+
+static void checkStrategyChange()
+{
+    Run expected = solve(Drive::Exec, NelderMeadStrategy::InsideContractionOnly, rosenbrock, 5, false);
+
+    CountedNelderMead solver(5, rosenbrock);
+    solver.setMaxIterations(3000);
+    solver.setStrategy(NelderMeadStrategy::InsideContractionOnly);
+    std::vector<double> values(6);
+    solver.start(std::vector<double>(5, -1.2), 1.0e-10, 1.0);
+    solver.setStrategy(NelderMeadStrategy::RepeatedExpansion);
+    while (!solver.isDone()) {
+        for (uint32_t i = 0; i < solver.getPendingCount(); i++) {
+            values[i] = rosenbrock(solver.getPendingPoint(i));
+        }
+        solver.tell(values.data());
+    }
+
+    Run run;
+    run.results = solver.getLastExecResults();
+    for (int s = 0; s < 5; s++) {
+        run.steps[s] = solver.getInstrumentation().getStepCount((NelderMeadStep)s);
+    }
+    printf("strategy changed during a search: %s\n", sameRun(expected, run) ? "not used" : "used");
+    check(sameRun(expected, run), "a strategy set during a search is not used by it");
+}
+
+int main()
+{
+    checkDrives();
+    checkInsideContractionOnly();
+    checkMaxExpansions();
+    checkStrategyChange();
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,223 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Checks the convergence telemetry:
+//
+// - the checkpoints count up one at a time to 16, then always increase and
+//   reach about 16 million at the last sample
+// - every sample of a record is the best value among the evaluations up to
+//   its checkpoint, and a record filled during exec agrees with the results
+// - NaN values, first or later, never become the best value or the first one
+// - profile percentiles, reached counts, merge and the CSV output, for runs
+//   that reach the accuracies at known evaluation counts
+
+#include "nm.h"
+#include "nm_telemetry.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include <limits>
+#include <sstream>
+#include <string>
+
+
+static int failures = 0;
+
+static void check(bool condition, const char * what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static double rosenbrock(const std::vector<double> & x)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i + 1 < x.size(); i++) {
+        double a = x[i + 1] - x[i] * x[i];
+        double b = 1.0 - x[i];
+        sum += 100.0 * a * a + b * b;
+    }
+    return sum;
+}
+
+struct RecordedPolicies : NelderMeadDefaultPolicies {
+    using Instrumentation = NelderMeadConvergenceRecorder;
+};
+
+static void checkCheckpoints()
+{
+    bool counting = true;
+    bool increasing = true;
+    for (uint32_t i = 0; i < NelderMeadConvergenceRecord::capacity; i++) {
+        if (i < 16) {
+            counting = counting && NelderMeadConvergenceRecord::getCheckpoint(i) == i + 1;
+        }
+        if (i > 0) {
+            increasing = increasing && NelderMeadConvergenceRecord::getCheckpoint(i) > NelderMeadConvergenceRecord::getCheckpoint(i - 1);
+        }
+    }
+    uint32_t lastCheckpoint = NelderMeadConvergenceRecord::getCheckpoint(NelderMeadConvergenceRecord::capacity - 1);
+    printf("checkpoints: 1 to 16, then 19, 22, 26, 32 ... %u\n", lastCheckpoint);
+    check(counting, "checkpoints count up one at a time to 16");
+    check(increasing, "checkpoints increase");
+    check(lastCheckpoint == 1u << 24, "the last checkpoint is 2^24");
+}
+
+static void checkRecord()
+{
+    // a bumpy sequence whose best value changes at irregular counts
+    std::vector<double> values(300);
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = 100.0 / (1.0 + i) + (i % 7) * 3.0;
+    }
+
+    NelderMeadConvergenceRecorder recorder;
+    recorder.start();
+    for (double value : values) {
+        recorder.evaluated(value);
+    }
+    const NelderMeadConvergenceRecord & record = recorder.getRecord();
+
+    bool samples = true;
+    for (uint32_t i = 0; i < record.sampleCount; i++) {
+        double best = HUGE_VAL;
+        for (uint32_t j = 0; j < NelderMeadConvergenceRecord::getCheckpoint(i); j++) {
+            best = values[j] < best ? values[j] : best;
+        }
+        samples = samples && record.best[i] == best;
+    }
+    printf("record of 300 evaluations: %u samples, first %g, last %g\n", record.sampleCount, record.first, record.last);
+    uint32_t passed = 0;
+    while (NelderMeadConvergenceRecord::getCheckpoint(passed) <= 300) {
+        passed++;
+    }
+    check(record.sampleCount == passed, "one sample for every checkpoint passed");
+    check(samples, "samples are the best value up to their checkpoint");
+    check(record.evalCount == 300 && record.first == values[0], "evaluation count and first value");
+
+    // during a search
+    BasicNelderMead<RecordedPolicies> solver(4, rosenbrock);
+    solver.setMaxIterations(5000);
+    solver.exec(std::vector<double>(4, -1.2), 1.0e-10, 1.0);
+    const NelderMeadConvergenceRecord & searched = solver.getInstrumentation().getRecord();
+    const NelderMeadResults & results = solver.getLastExecResults();
+    printf("record of a search: %u evaluations, %u samples, last %g, results %u evaluations, min %g\n",
+        searched.evalCount, searched.sampleCount, searched.last, results.evalCount, results.min);
+    check(searched.evalCount == results.evalCount, "a search's record counts its evaluations");
+    check(searched.last == results.min, "a search's record ends at its minimum");
+    check(searched.first == rosenbrock(std::vector<double>(4, -1.2)), "a search's record starts at its start point");
+}
+
+static void checkNaN()
+{
+    double nan = std::numeric_limits<double>::quiet_NaN();
+
+    NelderMeadConvergenceRecorder recorder;
+    recorder.start();
+    for (double value : { nan, 5.0, nan, 3.0, nan, 4.0 }) {
+        recorder.evaluated(value);
+    }
+    const NelderMeadConvergenceRecord & record = recorder.getRecord();
+    printf("NaN first: first %g, last %g, samples %g %g %g %g %g %g\n", record.first, record.last,
+        record.best[0], record.best[1], record.best[2], record.best[3], record.best[4], record.best[5]);
+    check(record.evalCount == 6, "NaN values are counted as evaluations");
+    check(record.first == 5.0, "the first value is the first number");
+    check(record.last == 3.0, "NaN never becomes the best value");
+    check(record.best[0] == HUGE_VAL && record.best[1] == 5.0 && record.best[5] == 3.0, "samples skip NaN");
+
+    // A run that starts with NaN reaches the accuracies like one that does not
+    NelderMeadConvergenceProfile profile({ 1.0e-1 });
+    profile.add(record, 0.0);
+    check(profile.getReachedCount(0) == 0, "3 is not within 1e-1 of 0 measured from 5");
+    recorder.evaluated(nan);
+    recorder.evaluated(0.1);
+    profile.add(recorder.getRecord(), 0.0);
+    check(profile.getReachedCount(0) == 1 && profile.getPercentile(0, 0.5) == 8, "reached at the eighth evaluation");
+
+    // and a run that found no number reaches none
+    recorder.start();
+    recorder.evaluated(nan);
+    recorder.evaluated(nan);
+    profile.add(recorder.getRecord());
+    check(profile.getRunCount() == 3 && profile.getReachedCount(0) == 1, "a run of only NaN reaches nothing");
+}
+
+// Run r evaluates 1.0 until evaluation r + 2, where it finds 0.01, and then
+// continues to 200 evaluations. Runs from 100 on never improve.
+static NelderMeadConvergenceRecord stepRun(uint32_t r)
+{
+    NelderMeadConvergenceRecorder recorder;
+    recorder.start();
+    for (uint32_t i = 1; i <= 200; i++) {
+        recorder.evaluated(r < 100 && i >= r + 2 ? 0.01 : 1.0);
+    }
+    return recorder.getRecord();
+}
+
+// The first checkpoint at or after count evaluations
+static uint32_t checkpointFor(uint32_t count)
+{
+    uint32_t i = 0;
+    while (NelderMeadConvergenceRecord::getCheckpoint(i) < count) {
+        i++;
+    }
+    return NelderMeadConvergenceRecord::getCheckpoint(i);
+}
+
+static void checkProfile()
+{
+    // 1e-1 is reached when 0.01 is found, measured from 1.0 to 0, 1e-3 never
+    NelderMeadConvergenceProfile profile({ 1.0e-1, 1.0e-3 });
+    NelderMeadConvergenceProfile first({ 1.0e-1, 1.0e-3 });
+    NelderMeadConvergenceProfile second({ 1.0e-1, 1.0e-3 });
+    for (uint32_t r = 0; r < 110; r++) {
+        NelderMeadConvergenceRecord record = stepRun(r);
+        profile.add(record, 0.0);
+        (r % 2 ? first : second).add(record, 0.0);
+    }
+    first.merge(second);
+
+    // with 110 runs the p50 run is the 55th, which found 0.01 at evaluation 56,
+    // and the p90 run the 99th, at evaluation 100
+    uint32_t p50 = profile.getPercentile(0, 0.5);
+    uint32_t p90 = profile.getPercentile(0, 0.9);
+    uint32_t p99 = profile.getPercentile(0, 0.99);
+    printf("profile: %llu runs, %llu reached 1e-1, p50 %u, p90 %u, p99 %u\n", (unsigned long long)profile.getRunCount(),
+        (unsigned long long)profile.getReachedCount(0), p50, p90, p99);
+    check(profile.getRunCount() == 110, "run count");
+    check(profile.getReachedCount(0) == 100 && profile.getReachedCount(1) == 0, "reached counts");
+    check(p50 == checkpointFor(56), "p50 is the checkpoint after the 55th run reached");
+    check(p90 == checkpointFor(100), "p90 is the checkpoint after the 99th run reached");
+    check(p99 == 0, "p99 is not reached by 99% of the runs");
+
+    std::ostringstream csv;
+    profile.writeCsv(csv);
+    std::string expected = "accuracy,runs,reached,p50,p90,p99\n0.1,110,100," + std::to_string(p50) + "," +
+        std::to_string(p90) + ",\n0.001,110,0,,,\n";
+    printf("%s", csv.str().c_str());
+    check(csv.str() == expected, "CSV output");
+
+    std::ostringstream merged;
+    first.writeCsv(merged);
+    check(merged.str() == csv.str(), "merged profiles equal one profile of all runs");
+
+    profile.clear();
+    check(profile.getRunCount() == 0 && profile.getReachedCount(0) == 0, "clear");
+}
+
+int main()
+{
+    checkCheckpoints();
+    checkRecord();
+    checkNaN();
+    checkProfile();
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Checks NelderMeadWorstCaseSearch:
+//
+// - addFamily rejects names with whitespace, families with no variables, no
+//   evaluation function, no parameters, mismatched or empty parameter ranges
+// - with the Evaluations cost the worst cases are the same, bit for bit, on
+//   1, 2 and 4 threads
+// - fixtures read back as the cases that were written, exactly, also into a
+//   search that holds the families in another order, and replay to the same
+//   evaluation counts; lines with an unknown family, size or strategy are
+//   skipped
+
+#include "nm_worstcase.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <sstream>
+#include <stdexcept>
+
+
+static int failures = 0;
+
+static void check(bool condition, const char * what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static bool sameValues(const std::vector<double> & a, const std::vector<double> & b)
+{
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0;
+}
+
+// The configuration of two cases is the same, bit for bit
+static bool sameCase(const NelderMeadWorstCase & a, const NelderMeadWorstCase & b)
+{
+    return sameValues(a.params, b.params) && sameValues(a.start, b.start)
+        && memcmp(&a.scale, &b.scale, sizeof(double)) == 0
+        && memcmp(&a.reflection, &b.reflection, sizeof(double)) == 0
+        && memcmp(&a.contraction, &b.contraction, sizeof(double)) == 0
+        && memcmp(&a.expansion, &b.expansion, sizeof(double)) == 0
+        && a.strategy == b.strategy;
+}
+
+// A small search over the standard families, with cases that need 600
+// evaluations failing
+static void configure(NelderMeadWorstCaseSearch & search)
+{
+    for (const NelderMeadObjectiveFamily & family : NelderMeadWorstCaseSearch::getStandardFamilies(3)) {
+        search.addFamily(family);
+    }
+    search.setSeed(42);
+    search.setSampleCount(64);
+    search.setRoundCount(3);
+    search.setMutationCount(4);
+    search.setReportSize(8);
+    search.setMaxIterations(300);
+    search.setFailEvalCount(600);
+}
+
+static bool addThrows(const NelderMeadObjectiveFamily & family)
+{
+    NelderMeadWorstCaseSearch search(1);
+    try {
+        search.addFamily(family);
+    }
+    catch (const std::invalid_argument &) {
+        return true;
+    }
+    return false;
+}
+
+static void checkFamilies()
+{
+    NelderMeadObjectiveFamily valid = NelderMeadWorstCaseSearch::getStandardFamilies(2)[0];
+    check(!addThrows(valid), "a standard family is accepted");
+
+    NelderMeadObjectiveFamily family = valid;
+    family.name = "two words";
+    check(addThrows(family), "a name with whitespace throws");
+
+    family = valid;
+    family.size = 0;
+    check(addThrows(family), "a family with no variables throws");
+
+    family = valid;
+    family.evalFunc = nullptr;
+    check(addThrows(family), "a family with no evaluation function throws");
+
+    family = valid;
+    family.lowerParams.clear();
+    family.upperParams.clear();
+    check(addThrows(family), "a family with no parameters throws");
+
+    family = valid;
+    family.upperParams.push_back(1.0);
+    check(addThrows(family), "parameter bounds of different lengths throw");
+
+    family = valid;
+    family.lowerParams[0] = family.upperParams[0] + 1.0;
+    check(addThrows(family), "a lower bound above its upper bound throws");
+
+    family = valid;
+    family.lowerParams[0] = NAN;
+    check(addThrows(family), "a NaN bound throws");
+
+    family = valid;
+    family.lowerParams[0] = family.upperParams[0];
+    check(!addThrows(family), "a range of one value is accepted");
+}
+
+static void checkDeterminism()
+{
+    std::vector<NelderMeadWorstCase> first;
+    for (uint32_t threads : { 1u, 2u, 4u }) {
+        NelderMeadWorstCaseSearch search(threads);
+        configure(search);
+        search.exec();
+        const std::vector<NelderMeadWorstCase> & results = search.getLastExecResults();
+        printf("threads %u: %u cases, costliest %u evaluations\n", threads, (uint32_t)results.size(),
+            results.empty() ? 0 : results[0].evalCount);
+
+        if (threads == 1) {
+            first = results;
+            check(!first.empty(), "the search reports cases");
+            continue;
+        }
+        bool same = results.size() == first.size();
+        for (size_t i = 0; same && i < results.size(); i++) {
+            same = sameCase(results[i], first[i]) && results[i].family == first[i].family
+                && results[i].evalCount == first[i].evalCount && results[i].iterationCount == first[i].iterationCount
+                && memcmp(results[i].steps, first[i].steps, sizeof(first[i].steps)) == 0;
+        }
+        check(same, "the worst cases do not depend on the thread count");
+    }
+}
+
+static void checkFixtures()
+{
+    NelderMeadWorstCaseSearch search(2);
+    configure(search);
+    search.exec();
+
+    std::vector<NelderMeadWorstCase> failing;
+    for (const NelderMeadWorstCase & worstCase : search.getLastExecResults()) {
+        if (search.isFailing(worstCase)) {
+            failing.push_back(worstCase);
+        }
+    }
+
+    std::ostringstream out;
+    search.writeFixtures(out);
+    std::string written = out.str();
+
+    // lines the reader must skip: an unknown family, another size and a
+    // strategy that is out of range
+    std::string skipped = written.substr(0, written.find('\n') + 1);
+    std::string unknown = skipped;
+    unknown.replace(unknown.find("family=") + 7, 0, "no");
+    std::string resized = skipped;
+    resized.replace(resized.find("size=3"), 6, "size=4");
+    std::string strategy = skipped;
+    strategy.replace(strategy.find("strategy=") + 9, 1, "7");
+
+    // a search that holds the same families in reverse order
+    NelderMeadWorstCaseSearch reader(1);
+    std::vector<NelderMeadObjectiveFamily> families = NelderMeadWorstCaseSearch::getStandardFamilies(3);
+    for (size_t f = families.size(); f-- > 0;) {
+        reader.addFamily(families[f]);
+    }
+    reader.setMaxIterations(300);
+
+    for (int reverse = 0; reverse < 2; reverse++) {
+        const NelderMeadWorstCaseSearch & target = reverse ? reader : search;
+        std::istringstream in(unknown + written + resized + strategy);
+        std::vector<NelderMeadWorstCase> cases = target.readFixtures(in);
+        printf("%s: %u failing cases written, %u read\n", reverse ? "families reversed" : "same search",
+            (uint32_t)failing.size(), (uint32_t)cases.size());
+        check(!failing.empty(), "the search finds failing cases");
+        check(cases.size() == failing.size(), "every failing case is read and the bad lines are skipped");
+
+        bool same = true;
+        bool counts = true;
+        bool replayed = true;
+        for (size_t i = 0; i < cases.size() && i < failing.size(); i++) {
+            uint32_t family = reverse ? (uint32_t)families.size() - 1 - failing[i].family : failing[i].family;
+            same = same && sameCase(cases[i], failing[i]) && cases[i].family == family;
+            counts = counts && cases[i].evalCount == failing[i].evalCount;
+
+            NelderMeadWorstCase replay = cases[i];
+            target.replay(replay);
+            replayed = replayed && replay.evalCount == failing[i].evalCount && replay.iterationCount == failing[i].iterationCount;
+        }
+        check(same, "fixtures read back exactly, with the family found by name");
+        check(counts, "fixtures keep their evaluation counts");
+        check(replayed, "fixtures replay to the same evaluation counts");
+    }
+}
+
+int main()
+{
+    checkFamilies();
+    checkDeterminism();
+    checkFixtures();
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
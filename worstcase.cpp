@@ -0,0 +1,74 @@
+/**********************************************************************
+    Copyright (c) 2023  Marcel A. Samek. All rights reserved.
+    Licensed under the MIT License
+    See LICENSE file in the project root for full license information.
+ **********************************************************************/
+
+// Hunts for worst cases in the standard families and saves the failing ones
+// as fixtures for benchmark.cpp to replay.
+//
+//     worstcase [threads] [fixtures] [size ...]
+//
+// Runs a NelderMeadWorstCaseSearch with the Evaluations cost over the
+// standard families of every size, 2 and 6 by default, on the given number of
+// threads, the number of cores by default. Cases that hit the iteration limit
+// fail. The ranked report of each size is printed and the failing cases of all
+// of them are written to the fixtures file, worstcase.txt by default. The
+// search keeps its default iteration limit and tolerance, which is what
+// benchmark replays the fixtures with. The fixtures do not depend on the
+// thread count.
+
+#include "nm_worstcase.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+
+int main(int argc, char ** argv)
+{
+    uint32_t threads = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    const char * path = argc > 2 ? argv[2] : "worstcase.txt";
+    std::vector<uint32_t> sizes;
+    for (int i = 3; i < argc; i++) {
+        sizes.push_back((uint32_t)strtoul(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = { 2, 6 };
+    }
+
+    std::ofstream fixtures(path);
+    if (!fixtures) {
+        printf("could not write %s\n", path);
+        return 1;
+    }
+
+    uint32_t written = 0;
+    for (uint32_t size : sizes) {
+        NelderMeadWorstCaseSearch search(threads);
+        for (const NelderMeadObjectiveFamily & family : NelderMeadWorstCaseSearch::getStandardFamilies(size)) {
+            search.addFamily(family);
+        }
+        search.exec();
+
+        printf("size %u:\n", size);
+        search.writeReport(std::cout);
+        std::cout.flush();
+
+        std::ostringstream lines;
+        search.writeFixtures(lines);
+        std::istringstream counted(lines.str());
+        std::string line;
+        while (std::getline(counted, line)) {
+            written++;
+        }
+        fixtures << lines.str();
+    }
+
+    printf("%u fixtures written to %s\n", written, path);
+    return 0;
+}